@@ -6,10 +6,14 @@
 #include "Algae.h"
 #include "Event.h"
 #include "Params.h"
+#include "ParamsProfile.h"
+#include "Simulation.h"
 #include "tokens.h"
 #include "Window.h"
 
 using namespace std;
+
+typedef params::Active P;
 using String = std::string;
 
 Initializer<Algae> __Algae_initializer;
@@ -29,10 +33,12 @@ String Algae::player_name(void) const
     return "Algae";
 }
 
+/* photosynthesis is a series of energy ticks (see LifeForm.h) */
 Algae::Algae(void) {
-    SmartPointer<Algae> self{ this };
-    photo_event = new Event(algae_photo_time,
-        [self](void) { self->photosynthesize(); });
+    income.start = Event::now();
+    income.period = P::algae_photo_time();
+    income.amount = P::Algae_energy_gain();
+    income_limit = 2.0 * P::start_energy();
 }
 
 void Algae::draw(int x, int y) const
@@ -40,7 +46,7 @@ void Algae::draw(int x, int y) const
 #if DEBUG
     cout << "drawing Algae";
 #endif /* DEBUG */
-    win.draw_rectangle(x, y, x + 3, y + 3, true);
+    win().draw_rectangle(x, y, x + 3, y + 3, true);
 }
 
 Color Algae::my_color(void) const
@@ -50,7 +56,7 @@ Color Algae::my_color(void) const
 
 SmartPointer<LifeForm> Algae::create(void)
 {
-    return new Algae;
+    return make_smart<Algae>();
 }
 
 Action Algae::encounter(const ObjInfo&)
@@ -58,17 +64,8 @@ Action Algae::encounter(const ObjInfo&)
     return LIFEFORM_IGNORE;
 }
 
-void Algae::photosynthesize(void)
+void Algae::income_reached(void)
 {
-    photo_event = 0;
-    if (!is_alive) { return; }
-    energy += Algae_energy_gain;
-    if (energy > 2.0 * start_energy) {
-        SmartPointer<Algae> child = new Algae;
-        reproduce(child);
-    }
-    SmartPointer<Algae> self{ this };
-    photo_event = new Event(algae_photo_time,
-        [self](void) { self->photosynthesize(); });
+    reproduce(make_smart<Algae>());
 }
 
@@ -7,8 +7,7 @@
 
 class Algae : public LifeForm {
   static void initialize(void);
-  Event* photo_event;
-  void photosynthesize(void);
+  void income_reached(void);    // reproduce
 public:
   Algae(void);
   void draw(int,int) const;     // defines LifeForm::draw
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cmath>
+
+#include "BroadPhase.h"
+#include "Event.h"
+#include "LifeForm.h"
+#include "Params.h"
+#include "ParamsProfile.h"
+#include "QuadTree.h"
+#include "Simulation.h"
+
+using namespace std;
+
+typedef params::Active P;
+
+BroadPhase::BroadPhase(void)
+    : mode(EVENTS), crossings(0), last_check(0.0), step_event(nullptr),
+      steps(0), switches(0) {}
+
+/* the caller must have made our simulation current */
+void BroadPhase::start(void) {
+    last_check = Event::now();
+    (void) new Event(step_mode_check_interval, [this](void) { check(); });
+}
+
+/*
+ * A step may bring two movers closer by twice the distance the fastest
+ * one goes, which must not be more than encounter_distance
+ */
+static double step_time(double vmax) {
+    return max(P::encounter_distance() / (2.0 * vmax), P::min_delta_time());
+}
+
+void BroadPhase::check(void) {
+    SimTime now = Event::now();
+    SimTime elapsed = now - last_check;
+
+    /* crossings per mover per time unit: counted while the movers have
+       border_cross events, estimated from the distance to the edge of
+       their regions while they don't */
+    unsigned moving = 0;
+    double vmax = 0.0, estimate = 0.0;
+    for (LifeForm* k : LifeForm::all_life()) {
+        if (!k->is_alive || k->speed == 0.0) { continue; }
+        moving += 1;
+        vmax = max(vmax, k->speed);
+        if (mode == STEPPED) {
+            double d = LifeForm::space().distance_to_edge(k->pos, k->course);
+            estimate += k->speed / max(d, P::encounter_distance() / 2.0);
+        }
+    }
+
+    if (moving == 0) {
+        if (mode == STEPPED) { leave_stepped(); }
+    } else if (elapsed > 0.0) {
+        double rate = mode == EVENTS ? crossings / (moving * elapsed) : estimate / moving;
+        double steps_per_time = 1.0 / step_time(vmax);
+        if (mode == EVENTS && rate > step_mode_enter * steps_per_time) {
+            enter_stepped();
+        } else if (mode == STEPPED && rate < step_mode_leave * steps_per_time) {
+            leave_stepped();
+        }
+    }
+
+    crossings = 0;
+    last_check = now;
+    /* like the Tick, stop once nothing else can happen */
+    if (LifeForm::population() > 0) {
+        (void) new Event(step_mode_check_interval, [this](void) { check(); });
+    }
+}
+
+void BroadPhase::enter_stepped(void) {
+    mode = STEPPED;
+    switches += 1;
+    movers.clear();
+    double vmax = 0.0;
+    for (LifeForm* k : LifeForm::all_life()) {
+        if (!k->is_alive || k->speed == 0.0) { continue; }
+        if (k->border_cross_event) {
+            k->border_cross_event->cancel();
+            k->border_cross_event = nullptr;
+        }
+        k->stepped = true;
+        movers.push_back(WeakPointer<LifeForm>(k));
+        vmax = max(vmax, k->speed);
+    }
+    schedule_step(vmax);
+}
+
+void BroadPhase::leave_stepped(void) {
+    mode = EVENTS;
+    switches += 1;
+    if (step_event) {
+        step_event->cancel();
+        step_event = nullptr;
+    }
+    /* hand the movers their border_cross events back */
+    vector<WeakPointer<LifeForm>> old;
+    old.swap(movers);
+    for (const auto& w : old) {
+        SmartPointer<LifeForm> p = w.lock();
+        if (!p) { continue; }
+        p->stepped = false;
+        if (!p->is_alive) { continue; }
+        p->update_position();
+        p->compute_next_move();
+    }
+}
+
+void BroadPhase::add_mover(LifeForm* k) {
+    if (k->stepped) { return; }
+    k->stepped = true;
+    movers.push_back(WeakPointer<LifeForm>(k));
+    if (!step_event) { schedule_step(k->speed); }
+}
+
+void BroadPhase::schedule_step(double vmax) {
+    if (step_event) {
+        step_event->cancel();
+        step_event = nullptr;
+    }
+    if (vmax <= 0.0) { return; }    // add_mover starts the steps again
+    step_event = new Event(step_time(vmax), [this](void) { step(); });
+}
+
+void BroadPhase::step(void) {
+    step_event = nullptr;
+    steps += 1;
+
+    /* move everybody (add_mover may add to 'movers' meanwhile -- anybody
+       new is moved next time) */
+    vector<WeakPointer<LifeForm>> old;
+    old.swap(movers);
+    live.clear();
+    for (const auto& w : old) {
+        SmartPointer<LifeForm> p = w.lock();
+        if (!p) { continue; }
+        if (!p->is_alive || p->speed == 0.0) {
+            p->stepped = false;
+            continue;
+        }
+        p->update_position();
+        if (p->is_alive) { live.push_back(p); }
+        else { p->stepped = false; }
+    }
+
+    /* sweep and prune on x: only the movers less than encounter_distance
+       apart in x can be less than encounter_distance apart */
+    sort(live.begin(), live.end(),
+         [](const SmartPointer<LifeForm>& a, const SmartPointer<LifeForm>& b) {
+             return a->pos.xpos < b->pos.xpos
+                 || (a->pos.xpos == b->pos.xpos && a->pos.ypos < b->pos.ypos);
+         });
+    pairs.clear();
+    for (size_t i = 0; i < live.size(); ++i) {
+        const Point& here = live[i]->pos;
+        for (size_t j = i + 1; j < live.size() && live[j]->pos.xpos - here.xpos < P::encounter_distance(); ++j) {
+            if (here.distance(live[j]->pos) < P::encounter_distance()) {
+                pairs.push_back(make_pair(live[i], live[j]));
+            }
+        }
+    }
+
+    /* the stationary objects are all in the tree where they are --
+       each mover meets its closest one, as it would at a border crossing
+       (the closest object of all may well be another mover) */
+    for (const auto& p : live) {
+        SmartPointer<LifeForm> c;
+        double d = P::encounter_distance();
+        for (const auto& k : LifeForm::space().nearby(p->pos, P::encounter_distance())) {
+            if (k->speed == 0.0 && k->is_alive && p->pos.distance(k->pos) < d) {
+                c = k;
+                d = p->pos.distance(k->pos);
+            }
+        }
+        if (c) { pairs.push_back(make_pair(p, c)); }
+    }
+
+    /* earlier encounters can kill (or eat) the parties of later ones */
+    for (const auto& e : pairs) {
+        if (e.first->is_alive && e.second->is_alive
+            && e.first->pos.distance(e.second->position_at(Event::now())) < P::encounter_distance()) {
+            e.first->resolve_encounter(e.second);
+        }
+    }
+    pairs.clear();
+
+    for (const auto& p : live) {
+        if (p->is_alive && p->speed > 0.0) { movers.push_back(WeakPointer<LifeForm>(p)); }
+        else { p->stepped = false; }
+    }
+    live.clear();
+    /* (including anybody add_mover found meanwhile) */
+    double vmax = 0.0;
+    for (const auto& w : movers) {
+        SmartPointer<LifeForm> p = w.lock();
+        if (p) { vmax = max(vmax, p->speed); }
+    }
+    if (mode == STEPPED) { schedule_step(vmax); }
+}
@@ -0,0 +1,74 @@
+#if !(_BroadPhase_h)
+#define _BroadPhase_h 1
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "SimTime.h"
+#include "SmartPointer.h"
+
+class Event;
+class LifeForm;
+
+/*
+ * Class name: BroadPhase
+ * Description:
+ *  Finds the encounters between moving objects.  Normally that is done
+ *  by the LifeForms themselves: each moving object has a border_cross
+ *  event for the next time it leaves its QuadTree region, and looks for
+ *  its closest neighbour when it gets there.  When the tree is crowded the
+ *  regions are tiny, and every mover crosses a border many times per time
+ *  unit -- each one a trip through the event queue.
+ *
+ *  Every step_mode_check_interval the BroadPhase compares the border
+ *  crossings per mover with the number of time steps a mover would need
+ *  per time unit (a step may move two movers towards each other by at
+ *  most encounter_distance).  Above step_mode_enter times that, it
+ *  switches to STEPPED: the movers lose their border_cross events, and
+ *  one step event moves all of them at once and finds the pairs within
+ *  encounter_distance by sweep and prune on x (and each mover's closest
+ *  stationary neighbour within encounter_distance in the tree).  Below
+ *  step_mode_leave times that it goes back to EVENTS.
+ *
+ *  Either way an encounter is checked at least as often as the movers
+ *  used to cross borders, so no encounter that the events would have
+ *  found is missed for longer than the events would have missed it.
+ */
+class BroadPhase {
+public:
+    enum Mode { EVENTS, STEPPED };
+private:
+    Mode mode;
+    uint64_t crossings;         // border crossings since the last check
+    SimTime last_check;
+    Event* step_event;          // the next step (while STEPPED)
+
+    /* the movers (STEPPED), each one has LifeForm::stepped set */
+    std::vector<WeakPointer<LifeForm>> movers;
+
+    /* scratch space for step() */
+    std::vector<SmartPointer<LifeForm>> live;
+    std::vector<std::pair<SmartPointer<LifeForm>, SmartPointer<LifeForm>>> pairs;
+
+    void enter_stepped(void);
+    void leave_stepped(void);
+    void schedule_step(double vmax);
+public:
+    uint64_t steps;             // step events so far
+    uint64_t switches;          // mode changes so far
+
+    BroadPhase(void);
+
+    Mode get_mode(void) const { return mode; }
+    bool is_stepped(void) const { return mode == STEPPED; }
+
+    void crossed(void) { crossings += 1; }  // a border_cross event happened
+    void add_mover(LifeForm*);              // a LifeForm started moving (STEPPED)
+
+    void start(void);           // schedule the first check
+    void check(void);           // measure the crossing rate, maybe switch mode
+    void step(void);            // move every mover, resolve the encounters
+};
+
+#endif /* !(_BroadPhase_h) */
@@ -26,15 +26,13 @@ String Craig::species_name(void) const
 
 Action Craig::encounter(const ObjInfo& info)
 {
-    if (info.species == species_name()) {
+    if (info.species.id() == species_id()) {
         /* don't be cannibalistic */
         set_course(info.bearing + M_PI);
         return LIFEFORM_IGNORE;
     }
     else {
-        hunt_event->cancel();
-        SmartPointer<Craig> self = SmartPointer<Craig>(this);
-        hunt_event = new Event(0.0, [self](void) { self->hunt(); });
+        new_decision(0.0);
         return LIFEFORM_EAT;
     }
 }
@@ -49,22 +47,20 @@ void Craig::initialize(void) {
  * you must wait until the object is actually alive
  */
 Craig::Craig() {
-    SmartPointer<Craig> self = SmartPointer<Craig>(this);
-    new Event(0, [self](void) { self->startup(); });
+    WeakPointer<Craig> self{ this };
+    new Event(0, [self](void) { if (auto p = self.lock()) { p->startup(); } }, this);
 }
 
 Craig::~Craig() {}
 
 void Craig::startup(void) {
-    set_course(drand48() * 2.0 * M_PI);
-    set_speed(2 + 5.0 * drand48());
-    SmartPointer<Craig> self = SmartPointer<Craig>(this);
-    hunt_event = new Event(0, [self](void) { self->hunt(); });
+    set_course(uniform() * 2.0 * M_PI);
+    set_speed(2 + 5.0 * uniform());
+    new_decision(0);
 }
 
-void Craig::spawn(void) {
-    SmartPointer<Craig> child = new Craig;
-    reproduce(child);
+SmartPointer<LifeForm> Craig::offspring(void) {
+    return make_smart<Craig>();
 }
 
 
@@ -73,30 +69,28 @@ Color Craig::my_color(void) const {
 }
 
 SmartPointer<LifeForm> Craig::create(void) {
-    return new Craig;
+    return make_smart<Craig>();
 }
 
 
-void Craig::hunt(void) {
-    const String fav_food = "Algae";
-
-    hunt_event = nullptr;
-    if (health() == 0.0) { return; } // we died
+/*
+ * hunt: head for the closest Algae, and look again in 10 time units
+ */
+void Craig::decide(Decision& d) {
+    static const SpeciesID fav_food = SpeciesTable::intern("Algae");
 
     ObjList prey = perceive(20.0);
 
     double best_d = HUGE;
     for (ObjList::iterator i = prey.begin(); i != prey.end(); ++i) {
-        if ((*i).species == fav_food) {
+        if ((*i).species.id() == fav_food) {
             if (best_d > (*i).distance) {
-                set_course((*i).bearing);
+                d.steer((*i).bearing);
                 best_d = (*i).distance;
             }
         }
     }
 
-    SmartPointer<Craig> self = SmartPointer<Craig>(this);
-    hunt_event = new Event(10.0, [self](void) { self->hunt(); });
-
-    if (health() >= 4.0) spawn();
+    d.next = 10.0;
+    d.reproduce_at = 4.0;
 }
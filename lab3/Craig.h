@@ -8,10 +8,9 @@
 class Craig : public LifeForm {
 protected:
   static void initialize(void);
-  void spawn(void);
-  void hunt(void);
+  void decide(Decision&);       // hunt
+  SmartPointer<LifeForm> offspring(void);
   void startup(void);
-  Event* hunt_event;
 public:
   Craig(void);
   ~Craig(void);
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cassert>
+
+#include "Decisions.h"
+#include "Event.h"
+#include "LifeForm.h"
+#include "Params.h"
+#include "Random.h"
+#include "Simulation.h"
+
+using namespace std;
+
+#if PARALLEL_DECISIONS
+
+Decisions::Decisions(Simulation& sim)
+    : sim(sim), batches(0), busy(0), quit(false), next(0) {}
+
+void Decisions::add(LifeForm* k) {
+    assert(!k->queued);
+    k->queue_pos = queue.insert(make_pair(k->decision_event->time(), k));
+    k->queued = true;
+}
+
+void Decisions::drop(LifeForm* k) {
+    if (!k->queued) { return; }
+    queue.erase(k->queue_pos);
+    k->queued = false;
+}
+
+/*
+ * decide the next LifeForm in the batch, and the next, ...  Perceiving
+ * only reads the world, except for the reference counts of the
+ * SmartPointers it copies (SMARTPTR_ATOMIC) and the species IDs, which
+ * birth looked up already
+ */
+void Decisions::work(void) {
+    EventQueue clock;           // Event::now() is the decision's time
+    EventQueue* prev = Event::use_queue(&clock);
+    epl::Xoshiro256* generator = epl::current_generator;
+    for (size_t k; (k = next.fetch_add(1, memory_order_relaxed)) < batch.size(); ) {
+        LifeForm* who = batch[k];
+        clock.now = who->decision_event->time();
+        epl::current_generator = &who->generator; // epl::drand48 too
+        LifeForm::deciding = &who->early;
+        who->decide(who->early);
+        who->decided = true;
+        assert(Event::num_events() == 0); // decide() may not schedule anything
+    }
+    LifeForm::deciding = nullptr;
+    epl::current_generator = generator;
+    Event::use_queue(prev);
+}
+
+void Decisions::worker(uint64_t seen) {
+    Simulation::Scope scope(sim);
+    for (;;) {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [this, seen](void) { return quit || batches != seen; });
+            if (quit) { return; }
+            seen = batches;
+        }
+        work();
+        lock_guard<mutex> guard(lock);
+        if (--busy == 0) { idle.notify_one(); }
+    }
+}
+
+void Decisions::start(unsigned threads) {
+    for (unsigned k = 1; k < threads; ++k) { // we are one of them
+        uint64_t seen = batches;
+        workers.push_back(thread([this, seen](void) { worker(seen); }));
+    }
+}
+
+void Decisions::stop(void) {
+    {
+        lock_guard<mutex> guard(lock);
+        quit = true;
+    }
+    wake.notify_all();
+    for (thread& t : workers) { t.join(); }
+    workers.clear();
+    quit = false;
+}
+
+/* handing a batch to the other threads costs about as much as making
+   a few decisions, so small batches are made on this thread */
+static const size_t min_shared_batch = 16;
+
+void Decisions::decide_until(SimTime limit) {
+    batch.clear();
+    while (!queue.empty() && queue.begin()->first <= limit) {
+        LifeForm* k = queue.begin()->second;
+        k->queued = false;
+        batch.push_back(k);
+        queue.erase(queue.begin());
+    }
+    next = 0;
+    if (batch.size() < min_shared_batch) {
+        work();
+        return;
+    }
+
+    unsigned threads = decision_threads ? decision_threads : max(1u, thread::hardware_concurrency());
+    if (threads != workers.size() + 1) {
+        stop();
+        start(threads);
+    }
+    {
+        lock_guard<mutex> guard(lock);
+        batches += 1;
+        busy = workers.size();
+    }
+    wake.notify_all();
+    work();
+    unique_lock<mutex> guard(lock);
+    idle.wait(guard, [this](void) { return busy == 0; });
+}
+
+#endif /* PARALLEL_DECISIONS */
@@ -0,0 +1,76 @@
+#if !(_Decisions_h)
+#define _Decisions_h 1
+
+#if PARALLEL_DECISIONS
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SimTime.h"
+
+class LifeForm;
+class Simulation;
+
+/* the decisions that are scheduled but not made yet, by when they are due */
+typedef std::multimap<SimTime, LifeForm*> DecisionQueue;
+
+/*
+ * Class name: Decisions
+ * Description:
+ *  Makes LifeForm decisions a batch at a time (compile with
+ *  -DPARALLEL_DECISIONS=1; see LifeForm::decide).  Each Simulation has
+ *  one.  A LifeForm's decision is in the queue from new_decision until
+ *  it is made (or the LifeForm dies), so that a batch takes just the
+ *  ones it needs from the front.
+ *
+ *  decide_until is called by the simulation's thread, which makes
+ *  decisions too and returns once all of them are made.  Until then
+ *  nothing else happens in the simulation, so the world the decisions
+ *  perceive is frozen.  A decision is made with the clock at the time
+ *  it is due (each thread has an EventQueue of its own, which is only
+ *  used for its clock), and is kept in the LifeForm until its event
+ *  comes up.  Which thread made it makes no difference to the result
+ *  (checks/decisions, run by "make check", compares 1 and 4 threads).
+ *
+ *  The threads are started by the first batch big enough to share, and
+ *  wait for the next one in between.
+ */
+class Decisions {
+    Simulation& sim;
+    DecisionQueue queue;
+    std::vector<LifeForm*> batch;
+
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wake;   // a new batch (or quit)
+    std::condition_variable idle;   // the last worker is done with it
+    uint64_t batches;               // started so far
+    unsigned busy;                  // workers still on the current batch
+    bool quit;
+    std::atomic<size_t> next;       // the next one in batch to decide
+
+    void work(void);                // decide until the batch runs out
+    void worker(uint64_t seen);     // body of a worker thread (seen: batches before it)
+    void start(unsigned threads);
+
+    Decisions(const Decisions&) = delete;
+    void operator=(const Decisions&) = delete;
+public:
+    explicit Decisions(Simulation& sim);
+    ~Decisions(void) { stop(); }
+
+    void add(LifeForm*);            // its decision_event is scheduled
+    void drop(LifeForm*);           // it is cancelled (or done without a batch)
+    void decide_until(SimTime limit); // make every decision due by then
+    void stop(void);                // join the threads (e.g., before a fork)
+    uint64_t shared(void) const { return batches; } // batches handed to the threads
+};
+
+#endif /* PARALLEL_DECISIONS */
+
+#endif /* !(_Decisions_h) */
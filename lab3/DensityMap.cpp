@@ -0,0 +1,48 @@
+#include <algorithm>
+#include <cmath>
+
+#include "DensityMap.h"
+#include "FrameBuffer.h"
+
+using namespace std;
+
+DensityMap::DensityMap(const Viewport& view)
+    : width(view.get_width()), height(view.get_height()),
+      x0(view.left()), y0(view.bottom()),
+      x_scale(width / view.span()), y_scale(height / view.span()),
+      count((size_t) width * height), rgb((size_t) width * height * 3) {}
+
+void DensityMap::clear(void) {
+    fill(count.begin(), count.end(), 0.0f);
+    fill(rgb.begin(), rgb.end(), 0.0f);
+}
+
+void DensityMap::add(double x, double y, unsigned n, Color c) {
+    int px = min(width - 1, max(0, (int) ((x - x0) * x_scale)));
+    int py = min(height - 1, max(0, (int) ((y - y0) * y_scale)));
+    size_t k = (size_t) py * width + px;
+    const uint8_t* color = FrameBuffer::palette(c);
+    count[k] += n;
+    rgb[3 * k] += n * color[0];
+    rgb[3 * k + 1] += n * color[1];
+    rgb[3 * k + 2] += n * color[2];
+}
+
+void DensityMap::to_rgba(vector<uint8_t>& out) const {
+    out.resize(count.size() * 4);
+    float most = *max_element(count.begin(), count.end());
+    float scale = most > 0.0f ? 1.0f / log1p(most) : 0.0f;
+    for (size_t k = 0; k < count.size(); ++k) {
+        uint8_t* p = &out[4 * k];
+        if (count[k] == 0.0f) {
+            p[0] = p[1] = p[2] = 0;
+        } else {
+            /* never quite black: a lone LifeForm should still show up */
+            float v = (0.3f + 0.7f * log1p(count[k]) * scale) / count[k];
+            p[0] = (uint8_t) (rgb[3 * k] * v);
+            p[1] = (uint8_t) (rgb[3 * k + 1] * v);
+            p[2] = (uint8_t) (rgb[3 * k + 2] * v);
+        }
+        p[3] = 255;
+    }
+}
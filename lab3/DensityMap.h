@@ -0,0 +1,45 @@
+#if !(_DensityMap_h)
+#define _DensityMap_h 1
+
+#include <cstdint>
+#include <vector>
+
+#include "Color.h"
+#include "Viewport.h"
+
+/*
+ * Class name: DensityMap
+ * Description:
+ *  A per-pixel picture of where the LifeForms are, for populations too
+ *  big to draw one at a time.  Feed it (position, count, color) triples
+ *  -- e.g., from QuadTree::visit_density with a pixel-sized cell -- and
+ *  it blends them into one colour per pixel:
+ *
+ *    hue        the count-weighted mix of the species colours that
+ *               landed on the pixel
+ *    brightness log(1 + count), relative to the most crowded pixel
+ *
+ *  It covers the part of the world in a Viewport; anything outside is
+ *  clamped to the border pixels.  Empty pixels stay black.  The cost is
+ *  O(pixels + calls to add).
+ */
+class DensityMap {
+    int width, height;
+    double x0, y0;              // the world coordinates of pixel (0, 0)
+    double x_scale, y_scale;    // pixels per world unit
+    std::vector<float> count;   // per pixel
+    std::vector<float> rgb;     // per pixel, the sum of count * colour
+
+public:
+    explicit DensityMap(const Viewport&);
+
+    double cell_size(void) const { return 1.0 / x_scale; } // world units per pixel
+
+    void clear(void);
+    void add(double x, double y, unsigned n, Color);
+
+    /* the picture, width * height RGBA pixels, top row first */
+    void to_rgba(std::vector<uint8_t>& out) const;
+};
+
+#endif /* !(_DensityMap_h) */
@@ -8,7 +8,7 @@
 
 using namespace std;
 
-SimTime Event::_now = 0;
+thread_local EventQueue* Event::queue = nullptr;
 
 struct EventCompare {
   bool operator()(const Event* ep1, const Event* ep2) {
@@ -17,30 +17,103 @@ struct EventCompare {
   }
 };
 
+/*
+ * A binary heap that keeps each Event's heap_index up to date, so that
+ * any event (not just the next one) can be taken out in O(log n)
+ */
 class PQueue {
 	vector<Event*> V;
+	unsigned batches;           // open Event::Batch scopes
+	size_t heap_size;           // V[0, heap_size) is a heap (during a batch)
+
+	void place(size_t k, Event* e) {
+		V[k] = e;
+		e->heap_index = k;
+	}
+
+	void sift_up(size_t k) {
+		Event* e = V[k];
+		while (k > 0) {
+			size_t parent = (k - 1) / 2;
+			if (!EventCompare()(V[parent], e)) break;
+			place(k, V[parent]);
+			k = parent;
+		}
+		place(k, e);
+	}
+
+	void sift_down(size_t k) {
+		Event* e = V[k];
+		size_t n = V.size();
+		for (;;) {
+			size_t c = 2 * k + 1;
+			if (c >= n) break;
+			if (c + 1 < n && EventCompare()(V[c], V[c + 1])) c += 1;
+			if (!EventCompare()(e, V[c])) break;
+			place(k, V[c]);
+			k = c;
+		}
+		place(k, e);
+	}
 public:
-	PQueue(void) {} // normal construction
+	PQueue(void) : batches(0), heap_size(0) {} // normal construction
 	~PQueue(void);
   
 	void insert(Event* e) {
 		V.push_back(e);
-		push_heap(V.begin(), V.end(), EventCompare());
+		e->heap_index = V.size() - 1;
+		if (batches == 0) sift_up(V.size() - 1);
+	}
+
+	void begin_batch(void) {
+		if (batches++ == 0) heap_size = V.size();
+	}
+
+	/* re-heap all at once if the batch was big, otherwise a
+	   sift_up per new event is cheaper */
+	void end_batch(void) {
+		assert(batches > 0);
+		if (--batches > 0) return;
+		size_t added = V.size() - heap_size;
+		if (added > heap_size / 8) {
+			for (size_t k = V.size() / 2; k-- > 0; )
+				sift_down(k);
+		} else {
+			for (size_t k = heap_size; k < V.size(); ++k)
+				sift_up(k);
+		}
 	}
 
 	Event* pop_greatest(void) {
-		pop_heap(V.begin(), V.end(), EventCompare());
-		Event* e = V.back();
-		V.pop_back();
+		assert(batches == 0);
+		Event* e = V.front();
+		remove(e);
 		return e;
 	}
 
   
+  /* e's time has changed: let it find its level */
+  void update(Event* e) {
+	  assert(batches == 0);
+	  sift_up(e->heap_index);
+	  sift_down(e->heap_index);
+  }
+
   /*
-   * remove an event from the queue
+   * remove an event from the queue: move the last event into its
+   * place and let that one find its level
    */
   void remove(Event* e) {
-	  e->cancel();
+	  assert(batches == 0);
+	  size_t k = e->heap_index;
+	  assert(k < V.size() && V[k] == e);
+	  Event* last = V.back();
+	  V.pop_back();
+	  if (last != e) {
+		  place(k, last);
+		  sift_up(k);
+		  sift_down(last->heap_index);
+	  }
   }
 
   unsigned size(void) const {
@@ -50,55 +123,119 @@ public:
 
 /* delete all of the events */
 PQueue::~PQueue() {
-  /* this look relies on the events removing themselves from the queue */
-  /* it's slow, but it's simple (and who cares how fast it is, 
-     the program's over by now */
-  while (!V.empty()) {
-    Event* e = V.front();
+  /* the events are taken out of the queue first -- ~Event insists
+     that an event is not in the queue when it is deleted */
+  for (Event* e : V) {
+    e->in_queue = false;
     delete e;
   }
 }
 
-PQueue Event::equeue;
+EventQueue::EventQueue(void) : pq(new PQueue), now(0), dispatched(0) {}
+
+EventQueue::~EventQueue(void) {
+  delete pq;
+}
+
+void EventQueue::clear(void) {
+  /* swap in the new queue first -- deleting an event can run other
+     destructors, and they should see an empty queue */
+  PQueue* old = pq;
+  pq = new PQueue;
+  delete old;
+}
 
 
+Event::Batch::Batch(void) {
+	queue->pq->begin_batch();
+}
+
+Event::Batch::~Batch(void) {
+	queue->pq->end_batch();
+}
+
 Event::~Event() {
 	assert(!in_queue);
+	unlink_owner();
+}
+
+void Event::unlink_owner(void) {
+	if (!owner) return;
+	if (prev_owned) prev_owned->next_owned = next_owned;
+	else owner->owned = next_owned;
+	if (next_owned) next_owned->prev_owned = prev_owned;
+	owner = nullptr;
+	next_owned = prev_owned = nullptr;
+}
+
+/*
+ * each event is taken off our list (by ~Event) before it is deleted,
+ * so just keep deleting the first one
+ */
+void EventOwner::cancel_events(void) {
+	while (owned) {
+		Event* e = owned;
+		if (e->in_queue) e->remove();
+		delete e;
+	}
 }
 
 /*
  * simulate until there are no more events to simulate
  */
 void Event::do_next(void) {
-	Event* e = equeue.pop_greatest();
+	Event* e = queue->pq->pop_greatest();
 	e->in_queue = false;
-	assert(e->t >= _now);
-	_now = e->t;
+#if PROFILE_EVENTS
+	uint32_t account = e->owner ? e->owner->cost_account() : e->account;
+#endif /* PROFILE_EVENTS */
+#if TRACE_EVENTS
+	uint64_t object = 0;
+	uint32_t species = Trace::NO_SPECIES;
+	if (Trace::current && e->owner) {
+		object = e->owner->trace_object();
+		species = e->owner->cost_account();
+	}
+#endif /* TRACE_EVENTS */
+	e->unlink_owner();          // it's too late for the owner to cancel it
+	assert(e->t >= queue->now);
+	queue->now = e->t;
+	queue->dispatched += 1;
 #if DEBUG
-	cout << "doing event at time " << _now << endl;
+	cout << "doing event at time " << now() << endl;
 #endif /* DEBUG */
-	(*e)();
+	{
+#if PROFILE_EVENTS
+		Profile::Dispatch charge(account, e->doit.target_type());
+#endif /* PROFILE_EVENTS */
+#if TRACE_EVENTS
+		Trace::Span span(e->doit.target_type(), queue->now, object, species);
+#endif /* TRACE_EVENTS */
+		(*e)();
+	}
 	delete e;
 }
 
 unsigned Event::num_events(void) {
-	return equeue.size();
+	return queue->pq->size();
 }
 
 void Event::remove(void) {
 	assert(in_queue);
-	equeue.remove(this);
+	queue->pq->remove(this);
 	in_queue = 0;
 }
 
+void Event::reschedule(SimTime delta_time) {
+	assert(in_queue);
+	if (delta_time < params::Active::min_delta_time()) delta_time = params::Active::min_delta_time();
+	t = now() + delta_time;
+	queue->pq->update(this);
+}
+
 void Event::insert() {
 	in_queue = true;
-	assert(Event::_now <= t);
-	equeue.insert(this);
+	assert(now() <= t);
+	queue->pq->insert(this);
 }
 
-
-/*void Event::delete_matching(void* p)
-{ 
-  equeue.delete_matching(p);
-}*/
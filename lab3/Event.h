@@ -2,14 +2,86 @@
 #define _Event_h 1
 
 #include <cassert>
+#include <cstdint>
 #include <functional>
+#include <utility>
 #include <limits.h>
 
-#include "Params.h"
+#include "MemoryAccount.h"
+#include "ParamsProfile.h"
+#include "Profile.h"
 #include "SimTime.h"            // for the SimTime class
+#include "Trace.h"
 
 /* necessary forward reference */
 class PQueue;
+class Event;
+
+/*
+ * Class name: EventQueue
+ * Description:
+ *  The scheduler state for one simulation: the pending events, the
+ *  current time and a count of the events processed so far.
+ *  Each Simulation owns one.  Event works with whichever EventQueue
+ *  is current on the calling thread (see Simulation::Scope), so
+ *  several simulations can run side by side on different threads.
+ */
+class EventQueue {
+    PQueue* pq;
+    SimTime now;
+    uint64_t dispatched;
+
+    EventQueue(const EventQueue&) = delete;
+    void operator=(const EventQueue&) = delete;
+    friend class Event;
+    friend class Decisions;     // sets the clock of a decision's queue
+public:
+    EventQueue(void);
+    ~EventQueue(void);          // deletes any events that never happened
+
+    void clear(void);           // delete all pending events (the clock is unchanged)
+};
+
+/*
+ * Class name: EventOwner
+ * Description:
+ *  Something (e.g., a LifeForm) whose events should all go away together.
+ *  An Event made with an owner is kept on the owner's list until it is
+ *  processed or deleted.  cancel_events() takes every one of them out of
+ *  the queue and deletes it, so they are never processed at all.
+ *  An owner cancels its events when it is destroyed.
+ */
+class EventOwner {
+    Event* owned;               // pending events, linked through Event::next_owned
+
+    friend class Event;
+public:
+    EventOwner(void) : owned(nullptr) {}
+    EventOwner(const EventOwner&) : owned(nullptr) {} // a copy owns nothing (yet)
+    EventOwner& operator=(const EventOwner&) { return *this; }
+    ~EventOwner(void) { cancel_events(); }
+
+    void cancel_events(void);   // remove and delete all of our pending events
+
+#if PROFILE_EVENTS || TRACE_EVENTS
+    /* who pays for our events (see Profile.h) -- the species in a trace */
+    virtual uint32_t cost_account(void) const { return Profile::NO_ACCOUNT; }
+#endif /* PROFILE_EVENTS || TRACE_EVENTS */
+#if TRACE_EVENTS
+    virtual uint64_t trace_object(void) const { return 0; } // our ID in a trace
+#endif /* TRACE_EVENTS */
+};
+
+#if MEMORY_ACCOUNTING
+/* the callable an Event runs, wrapped so that it is counted as MEM_HANDLER
+   (every copy, including the one inside the std::function) */
+template <class F>
+struct HandlerPayload : Accounted<HandlerPayload<F>, MEM_HANDLER> {
+    F f;
+    explicit HandlerPayload(F f) : f(std::move(f)) {}
+    void operator()(void) { f(); }
+};
+#endif /* MEMORY_ACCOUNTING */
 
 /*
  * Class name: Event
@@ -35,14 +107,27 @@ class PQueue;
  *  operator = for class Event.
  *
  */
-class Event {
+class Event
+#if MEMORY_ACCOUNTING
+    : Accounted<Event, MEM_EVENT>
+#endif /* MEMORY_ACCOUNTING */
+{
 private:
     SimTime t;
     using Handler = std::function<void(void)>;
     Handler doit;
-    static PQueue equeue;         // a priority queue of all events
-    static SimTime _now;
+    static thread_local EventQueue* queue; // the current thread's scheduler
     bool in_queue;
+    uint32_t heap_index;          // where we are in the queue (if in_queue)
+
+    EventOwner* owner;            // may be null
+    Event* next_owned;            // the owner's list of pending events
+    Event* prev_owned;
+    void unlink_owner(void);
+
+#if PROFILE_EVENTS
+    uint32_t account;             // who was running when we were made
+#endif /* PROFILE_EVENTS */
 
     /* Implementation NOTE:
        If you inline these, you need to include the definition of PQueue
@@ -57,30 +142,78 @@ public:
     /* interface */
     void operator()(void) { if (active) { doit(); } }
 
-    static SimTime now(void) { return _now; }
+    static SimTime now(void) { return queue->now; }
     static unsigned num_events(void); // the total number of events in the world
+    static uint64_t num_dispatched(void) { return queue->dispatched; } // events processed so far
     static void do_next(void);    // process the next event
 
+    /* While a Batch is alive, new events are only collected; the queue
+       is rebuilt once when the Batch ends (O(n), rather than O(log n)
+       per event).  No event may be processed during a batch */
+    class Batch {
+        Batch(const Batch&) = delete;
+        void operator=(const Batch&) = delete;
+    public:
+        Batch(void);
+        ~Batch(void);
+    };
+
+    /* make q the current thread's scheduler, returns the previous one */
+    static EventQueue* use_queue(EventQueue* q) {
+        EventQueue* prev = queue;
+        queue = q;
+        return prev;
+    }
+
 
   /* constructors and destructors */
-    Event(SimTime delta_time, Handler f) : doit(f) {
-        if (delta_time < min_delta_time) delta_time = min_delta_time;
-        t = _now + delta_time;
-        active = true;
-        insert();
+#if MEMORY_ACCOUNTING
+    template <class F>
+    Event(SimTime delta_time, F f, EventOwner* owner = nullptr)
+        : doit(HandlerPayload<F>(std::move(f))), owner(owner),
+          next_owned(nullptr), prev_owned(nullptr) {
+        schedule(delta_time);
     }
+#else
+    Event(SimTime delta_time, Handler f, EventOwner* owner = nullptr)
+        : doit(std::move(f)), owner(owner), next_owned(nullptr), prev_owned(nullptr) {
+        schedule(delta_time);
+    }
+#endif /* MEMORY_ACCOUNTING */
     ~Event(void);
 
     void cancel(void) { if (this) active = false; }
     bool is_active(void) const { return this && active; }
 
+    SimTime time(void) const { return t; } // when it will happen
+    void reschedule(SimTime delta_time); // move a pending event to now() + delta_time
+                                // (O(log n), but not during a Batch)
+
 private:
+    /* the rest of the constructor */
+    void schedule(SimTime delta_time) {
+        if (delta_time < params::Active::min_delta_time()) delta_time = params::Active::min_delta_time();
+        t = now() + delta_time;
+        active = true;
+#if PROFILE_EVENTS
+        account = Profile::current_account();
+#endif /* PROFILE_EVENTS */
+        if (owner) {
+            next_owned = owner->owned;
+            if (next_owned) next_owned->prev_owned = this;
+            owner->owned = this;
+        }
+        insert();
+    }
+
     /* assignment and copying are forbidden in Events */
     Event(const Event& e) = delete;
     void operator=(const Event&) = delete;
 
     /* The EventCompare class is used in Event.cc to implement the Event Queue */
     friend struct EventCompare;
+    friend class PQueue;
+    friend class EventOwner;
 };
 
 #endif /* !(_Event_h) */
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include "FrameBuffer.h"
+#include "Window.h"
+
+using namespace std;
+
+/* the same colours the FLTK window uses */
+const uint8_t* FrameBuffer::palette(Color c) {
+    static const uint8_t colors[8][4] = {
+        {   0,   0,   0, 255 },     // BLACK
+        {   0,   0, 255, 255 },     // BLUE
+        {   0, 255,   0, 255 },     // GREEN
+        {   0, 255, 255, 255 },     // CYAN
+        { 255,   0, 255, 255 },     // MAGENTA
+        { 255,   0,   0, 255 },     // RED
+        { 255, 165,   0, 255 },     // ORANGE
+        { 255, 255,   0, 255 },     // YELLOW
+    };
+    return colors[c & 7];
+}
+
+FrameBuffer::FrameBuffer(int width, int height)
+    : width(width), height(height), background(BLACK) {}
+
+void FrameBuffer::clear(Color c) {
+    commands.clear();
+    images.clear();
+    background = c;
+}
+
+void FrameBuffer::rectangle(int x1, int y1, int x2, int y2, Color c, bool fill) {
+    commands.push_back(Command{ fill ? Command::FILL : Command::FRAME, x1, y1, x2, y2, c, 0 });
+}
+
+void FrameBuffer::draw_line(int x1, int y1, int x2, int y2, Color c) {
+    commands.push_back(Command{ Command::LINE, x1, y1, x2, y2, c, 0 });
+}
+
+void FrameBuffer::image(int x, int y, int w, int h, const uint8_t* rgba) {
+    commands.push_back(Command{ Command::IMAGE, x, y, x + w, y + h, BLACK, images.size() });
+    images.insert(images.end(), rgba, rgba + (size_t) w * h * 4);
+}
+
+void FrameBuffer::replay(Canvas& canvas) const {
+    for (const Command& c : commands) {
+        canvas.set_color(c.color);
+        switch (c.kind) {
+        case Command::FILL:
+        case Command::FRAME:
+            canvas.draw_rectangle(c.x1, c.y1, c.x2, c.y2, c.kind == Command::FILL);
+            break;
+        case Command::LINE:
+            canvas.draw_line(c.x1, c.y1, c.x2, c.y2);
+            break;
+        case Command::IMAGE:
+            canvas.draw_image(c.x1, c.y1, c.x2 - c.x1, c.y2 - c.y1, &images[c.data]);
+            break;
+        }
+    }
+}
+
+/* fill [x1, x2) x [y1, y2), clipped to the picture and to the band */
+void FrameBuffer::fill(int x1, int y1, int x2, int y2, const uint8_t* rgba,
+                       int y_min, int y_max) {
+    x1 = max(x1, 0);
+    x2 = min(x2, width);
+    y1 = max(y1, y_min);
+    y2 = min(y2, y_max);
+    for (int y = y1; y < y2; ++y) {
+        uint8_t* p = &pixels[((size_t) y * width + x1) * 4];
+        for (int x = x1; x < x2; ++x, p += 4) { memcpy(p, rgba, 4); }
+    }
+}
+
+/* Bresenham; only the pixels inside the band are written */
+void FrameBuffer::line(int x1, int y1, int x2, int y2, const uint8_t* rgba,
+                       int y_min, int y_max) {
+    int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+        if (y1 >= y_min && y1 < y_max && x1 >= 0 && x1 < width) {
+            memcpy(&pixels[((size_t) y1 * width + x1) * 4], rgba, 4);
+        }
+        if (x1 == x2 && y1 == y2) { break; }
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x1 += sx; }
+        if (e2 <= dx) { err += dx; y1 += sy; }
+    }
+}
+
+/* copy the rows of an IMAGE that are inside the picture and the band */
+void FrameBuffer::blit(const Command& c, int y_min, int y_max) {
+    int w = c.x2 - c.x1;
+    int x1 = max(c.x1, 0), x2 = min(c.x2, width);
+    if (x1 >= x2) { return; }
+    for (int y = max(c.y1, y_min); y < min(c.y2, y_max); ++y) {
+        const uint8_t* src = &images[c.data + ((size_t) (y - c.y1) * w + (x1 - c.x1)) * 4];
+        memcpy(&pixels[((size_t) y * width + x1) * 4], src, (size_t) (x2 - x1) * 4);
+    }
+}
+
+void FrameBuffer::draw_band(int y_min, int y_max) {
+    fill(0, y_min, width, y_max, palette(background), y_min, y_max);
+    for (const Command& c : commands) {
+        if (c.kind != Command::LINE && (c.y2 <= y_min || c.y1 >= y_max)) { continue; }
+        const uint8_t* rgba = palette(c.color);
+        switch (c.kind) {
+        case Command::FILL:
+            fill(c.x1, c.y1, c.x2, c.y2, rgba, y_min, y_max);
+            break;
+        case Command::FRAME:
+            fill(c.x1, c.y1, c.x2, c.y1 + 1, rgba, y_min, y_max);
+            fill(c.x1, c.y2 - 1, c.x2, c.y2, rgba, y_min, y_max);
+            fill(c.x1, c.y1, c.x1 + 1, c.y2, rgba, y_min, y_max);
+            fill(c.x2 - 1, c.y1, c.x2, c.y2, rgba, y_min, y_max);
+            break;
+        case Command::LINE:
+            line(c.x1, c.y1, c.x2, c.y2, rgba, y_min, y_max);
+            break;
+        case Command::IMAGE:
+            blit(c, y_min, y_max);
+            break;
+        }
+    }
+}
+
+void FrameBuffer::rasterize(BandPool* pool) {
+    pixels.resize((size_t) width * height * 4);
+    if (!pool || pool->size() == 1 || height < 2) {
+        draw_band(0, height);
+        return;
+    }
+    unsigned bands = min(pool->size(), (unsigned) height);
+    int rows = (height + bands - 1) / bands;
+    pool->run(bands, [this, rows](unsigned k) {
+        draw_band(min(height, (int) k * rows), min(height, (int) (k + 1) * rows));
+    });
+}
+
+BandPool::BandPool(unsigned threads)
+    : jobs(0), busy(0), quit(false), band(nullptr), num_bands(0), next(0) {
+    if (threads == 0) { threads = thread::hardware_concurrency(); }
+    for (unsigned k = 1; k < threads; ++k) { // the caller of run is one of them
+        workers.push_back(thread([this](void) { worker(0); }));
+    }
+}
+
+BandPool::~BandPool(void) {
+    {
+        lock_guard<mutex> guard(lock);
+        quit = true;
+    }
+    wake.notify_all();
+    for (thread& t : workers) { t.join(); }
+}
+
+void BandPool::work(void) {
+    for (unsigned k; (k = next.fetch_add(1, memory_order_relaxed)) < num_bands; ) {
+        (*band)(k);
+    }
+}
+
+void BandPool::worker(uint64_t seen) {
+    for (;;) {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [this, seen](void) { return quit || jobs != seen; });
+            if (quit) { return; }
+            seen = jobs;
+        }
+        work();
+        lock_guard<mutex> guard(lock);
+        if (--busy == 0) { idle.notify_one(); }
+    }
+}
+
+void BandPool::run(unsigned n, const function<void(unsigned)>& f) {
+    {
+        lock_guard<mutex> guard(lock);
+        band = &f;
+        num_bands = n;
+        next = 0;
+        jobs += 1;
+        busy = workers.size();
+    }
+    wake.notify_all();
+    work();
+    unique_lock<mutex> guard(lock);
+    idle.wait(guard, [this](void) { return busy == 0; });
+}
+
+bool FrameBuffer::write_ppm(const string& file_name) const {
+    ofstream out(file_name, ios::binary);
+    if (!out) { return false; }
+    out << "P6\n" << width << " " << height << "\n255\n";
+    vector<char> row((size_t) width * 3);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* p = &pixels[(size_t) y * width * 4];
+        for (int x = 0; x < width; ++x, p += 4) {
+            row[x * 3] = p[0];
+            row[x * 3 + 1] = p[1];
+            row[x * 3 + 2] = p[2];
+        }
+        out.write(row.data(), row.size());
+    }
+    return (bool) out;
+}
+
+/*
+ * PNG support: just enough of the format for an 8-bit RGBA image.
+ * The zlib stream uses "stored" (uncompressed) deflate blocks, so the
+ * files are a bit bigger than the image, but we don't need zlib
+ */
+namespace {
+    struct CrcTable {
+        uint32_t entry[256];
+    };
+
+    uint32_t crc32(const uint8_t* data, size_t n, uint32_t crc = 0) {
+        /* built once, by whichever thread gets here first */
+        static const CrcTable table = [](void) {
+            CrcTable t;
+            for (uint32_t k = 0; k < 256; ++k) {
+                uint32_t c = k;
+                for (int j = 0; j < 8; ++j) { c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1; }
+                t.entry[k] = c;
+            }
+            return t;
+        }();
+        crc = ~crc;
+        for (size_t k = 0; k < n; ++k) { crc = table.entry[(crc ^ data[k]) & 0xff] ^ (crc >> 8); }
+        return ~crc;
+    }
+
+    void put32(vector<uint8_t>& v, uint32_t x) {
+        v.push_back(x >> 24);
+        v.push_back(x >> 16);
+        v.push_back(x >> 8);
+        v.push_back(x);
+    }
+
+    void chunk(ofstream& out, const char* type, const vector<uint8_t>& data) {
+        vector<uint8_t> buf;
+        put32(buf, data.size());
+        buf.insert(buf.end(), type, type + 4);
+        buf.insert(buf.end(), data.begin(), data.end());
+        put32(buf, crc32(&buf[4], buf.size() - 4));
+        out.write((const char*) buf.data(), buf.size());
+    }
+}
+
+bool FrameBuffer::write_png(const string& file_name) const {
+    ofstream out(file_name, ios::binary);
+    if (!out) { return false; }
+    static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    out.write((const char*) signature, 8);
+
+    vector<uint8_t> header;
+    put32(header, width);
+    put32(header, height);
+    header.push_back(8);        // bits per channel
+    header.push_back(6);        // RGBA
+    header.push_back(0);        // deflate
+    header.push_back(0);        // adaptive filtering (we use filter 0 on every row)
+    header.push_back(0);        // no interlace
+    chunk(out, "IHDR", header);
+
+    /* the raw image: each row is a filter byte (0) and then the pixels */
+    size_t row_bytes = (size_t) width * 4;
+    vector<uint8_t> raw;
+    raw.reserve(height * (row_bytes + 1));
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0);
+        raw.insert(raw.end(), &pixels[y * row_bytes], &pixels[y * row_bytes] + row_bytes);
+    }
+
+    vector<uint8_t> z;
+    z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    z.push_back(0x78);          // deflate, 32K window
+    z.push_back(0x01);          // no preset dictionary, lowest level (and the check bits)
+    uint32_t a = 1, b = 0;      // adler32
+    for (size_t pos = 0; pos < raw.size() || pos == 0; ) {
+        size_t n = min((size_t) 65535, raw.size() - pos);
+        bool last = pos + n == raw.size();
+        z.push_back(last ? 1 : 0);
+        z.push_back(n & 0xff);
+        z.push_back(n >> 8);
+        z.push_back(~n & 0xff);
+        z.push_back((~n >> 8) & 0xff);
+        for (size_t k = pos; k < pos + n; ++k) {
+            a = (a + raw[k]) % 65521;
+            b = (b + a) % 65521;
+        }
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+        pos += n;
+        if (last) { break; }
+    }
+    put32(z, (b << 16) | a);
+    chunk(out, "IDAT", z);
+    chunk(out, "IEND", vector<uint8_t>());
+    return (bool) out;
+}
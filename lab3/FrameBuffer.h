@@ -0,0 +1,110 @@
+#if !(_FrameBuffer_h)
+#define _FrameBuffer_h 1
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Color.h"
+
+class Canvas;
+
+/*
+ * Class name: BandPool
+ * Description:
+ *  The threads FrameBuffer::rasterize draws its bands on.  They are
+ *  started once and wait for the next picture in between, since starting
+ *  a thread per band per frame can cost more than drawing the band.
+ *  run(n, band) calls band(0) ... band(n - 1) spread over the threads
+ *  (the caller is one of them) and returns when all of them are done.
+ */
+class BandPool {
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wake;   // a new job (or quit)
+    std::condition_variable idle;   // the last worker is done with it
+    uint64_t jobs;                  // started so far
+    unsigned busy;                  // workers still on the current job
+    bool quit;
+    const std::function<void(unsigned)>* band;
+    unsigned num_bands;
+    std::atomic<unsigned> next;     // the next band to draw
+
+    void work(void);
+    void worker(uint64_t seen);
+
+    BandPool(const BandPool&) = delete;
+    void operator=(const BandPool&) = delete;
+public:
+    explicit BandPool(unsigned threads = 0); // 0: one per core
+    ~BandPool(void);
+
+    unsigned size(void) const { return workers.size() + 1; }
+    void run(unsigned n, const std::function<void(unsigned)>& band);
+};
+
+/*
+ * Class name: FrameBuffer
+ * Description:
+ *  A software renderer for Canvas, for runs without a display.
+ *
+ *  The drawing calls only record commands (a clear() throws away the
+ *  commands from before it).  rasterize() turns the commands into RGBA
+ *  pixels, splitting the image into horizontal bands that are drawn on
+ *  the threads of a BandPool.  Every band replays all of the commands, clipped
+ *  to its own rows, so the result is the same as drawing them in order.
+ *  The image can then be saved as a binary PPM or as a PNG (with
+ *  uncompressed "stored" deflate blocks -- no zlib needed).  The commands
+ *  can also be replayed on a Canvas; the pixels are only allocated by
+ *  the first rasterize().
+ */
+class FrameBuffer {
+    struct Command {
+        enum Kind { FILL, FRAME, LINE, IMAGE } kind;
+        int x1, y1, x2, y2;
+        Color color;
+        size_t data;            // IMAGE: where its pixels start in 'images'
+    };
+
+    int width, height;
+    Color background;
+    std::vector<Command> commands;
+    std::vector<uint8_t> images;        // the pixels of the IMAGE commands
+    std::vector<uint8_t> pixels;        // RGBA, row by row, top row first
+
+    void draw_band(int y_min, int y_max); // rows [y_min, y_max)
+    void fill(int x1, int y1, int x2, int y2, const uint8_t* rgba, int y_min, int y_max);
+    void line(int x1, int y1, int x2, int y2, const uint8_t* rgba, int y_min, int y_max);
+    void blit(const Command&, int y_min, int y_max);
+public:
+    FrameBuffer(int width, int height);
+
+    int get_width(void) const { return width; }
+    int get_height(void) const { return height; }
+
+    /* recording */
+    void clear(Color = BLACK);
+    void rectangle(int x1, int y1, int x2, int y2, Color, bool fill = true);
+    void draw_line(int x1, int y1, int x2, int y2, Color);
+    void image(int x, int y, int w, int h, const uint8_t* rgba); // copies rgba
+    unsigned num_commands(void) const { return commands.size(); }
+
+    /* send the commands to a Canvas (e.g., a window, on another thread) */
+    void replay(Canvas&) const;
+
+    /* drawing, a band per thread of the pool (all on this thread without one) */
+    void rasterize(BandPool* pool = nullptr);
+    const uint8_t* rgba(void) const { return pixels.data(); }
+
+    bool write_ppm(const std::string& file_name) const;
+    bool write_png(const std::string& file_name) const;
+
+    static const uint8_t* palette(Color); // the RGBA of each Color
+};
+
+#endif /* !(_FrameBuffer_h) */
@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <iostream>
+
+#include "FrameRecorder.h"
+#include "LifeForm.h"
+#include "Params.h"
+#include "Simulation.h"
+
+using namespace std;
+
+/* frames drawn but not written yet, at most */
+static const unsigned frames_in_flight = 3;
+
+FrameRecorder::FrameRecorder(const string& prefix, SimTime interval, bool png)
+    : prefix(prefix), png(png), interval(interval), next_frame(Event::now()),
+      frames(0), quit(false) {
+    for (unsigned k = 0; k < frames_in_flight; ++k) {
+        buffers.push_back(FrameBuffer(win_x_size, win_y_size));
+        free_buffers.push_back(k);
+    }
+    writer = thread([this](void) { write(); });
+}
+
+FrameRecorder::~FrameRecorder(void) {
+    {
+        lock_guard<mutex> guard(lock);
+        quit = true;
+    }
+    ready.notify_one();
+    writer.join();
+}
+
+/*
+ * runs on the simulation thread
+ */
+void FrameRecorder::snapshot(void) {
+    unsigned k;
+    {
+        unique_lock<mutex> guard(lock);
+        returned.wait(guard, [this](void) { return !free_buffers.empty(); });
+        k = free_buffers.back();
+        free_buffers.pop_back();
+    }
+
+    Simulation& sim = Simulation::current();
+    sim.record_frames(&buffers[k]);
+    LifeForm::draw_all();
+    sim.record_frames(nullptr);
+
+    {
+        lock_guard<mutex> guard(lock);
+        queued.push_back(make_pair(k, frames));
+    }
+    ready.notify_one();
+    frames += 1;
+    next_frame = Event::now() + interval;
+}
+
+void FrameRecorder::write(void) {
+    for (;;) {
+        pair<unsigned, unsigned> job;
+        {
+            unique_lock<mutex> guard(lock);
+            ready.wait(guard, [this](void) { return quit || !queued.empty(); });
+            if (queued.empty()) { return; }     // quit, and everything is written
+            job = queued.front();
+            queued.pop_front();
+        }
+
+        FrameBuffer& frame = buffers[job.first];
+        frame.rasterize(&bands);
+        char number[16];
+        snprintf(number, sizeof(number), "%05u", job.second);
+        string file_name = prefix + number + (png ? ".png" : ".ppm");
+        if (!(png ? frame.write_png(file_name) : frame.write_ppm(file_name))) {
+            cerr << "FrameRecorder: cannot write " << file_name << "\n";
+        }
+
+        {
+            lock_guard<mutex> guard(lock);
+            free_buffers.push_back(job.first);
+        }
+        returned.notify_one();
+    }
+}
@@ -0,0 +1,60 @@
+#if !(_FrameRecorder_h)
+#define _FrameRecorder_h 1
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Event.h"
+#include "FrameBuffer.h"
+
+/*
+ * FrameRecorder saves a picture of the simulation every 'interval'
+ * sim-time units, as <prefix>00000.ppm, <prefix>00001.ppm, ... (or .png).
+ *
+ * The simulation thread calls poll() after every event, which is one
+ * comparison until the next frame is due.  Only then is the world drawn
+ * into a FrameBuffer (the Canvas records into it just for that one
+ * draw_all), which only records the drawing commands.  The FrameBuffer
+ * is then handed to the writer thread, which rasterises it on a BandPool
+ * and writes it out, while the simulation goes on.  There are a few
+ * FrameBuffers; if the writer falls that far behind, snapshot waits for
+ * it.  It needs neither X11 nor FLTK -- without a window the Simulation
+ * draws off screen.  The destructor writes whatever is still queued.
+ */
+class FrameRecorder {
+    std::string prefix;
+    bool png;
+    SimTime interval;
+    SimTime next_frame;
+    unsigned frames;
+
+    std::vector<FrameBuffer> buffers;
+    std::vector<unsigned> free_buffers;
+    std::deque<std::pair<unsigned, unsigned>> queued; // (buffer, frame number)
+    std::mutex lock;
+    std::condition_variable ready;      // something queued (or quit)
+    std::condition_variable returned;   // a buffer is free again
+    bool quit;
+    BandPool bands;
+    std::thread writer;
+
+    void write(void);                   // body of the writer thread
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    void operator=(const FrameRecorder&) = delete;
+public:
+    FrameRecorder(const std::string& prefix, SimTime interval, bool png = false);
+    ~FrameRecorder(void);
+
+    void poll(void) { if (Event::now() >= next_frame) { snapshot(); } }
+    void snapshot(void);        // save a frame now
+
+    unsigned num_frames(void) const { return frames; }
+};
+
+#endif /* !(_FrameRecorder_h) */
@@ -0,0 +1,123 @@
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "FreeList.h"
+
+using namespace std;
+
+namespace freelist {
+
+#if LIFEFORM_POOL
+struct Block { Block* next; };
+
+const size_t num_classes = max_size / granule;
+const size_t slab_size = 16 * 1024;
+
+static size_t size_class(size_t n) { return n == 0 ? 0 : (n - 1) / granule; }
+
+/* the free blocks of threads that have exited, and every slab (so the
+   memory stays reachable) */
+struct Shared {
+    mutex lock;
+    Block* spare[num_classes] = {};
+    vector<void*> slabs;
+};
+
+static Shared& shared(void) {
+    static Shared* s = new Shared; // never destroyed: blocks may be freed during exit
+    return *s;
+}
+
+/* plain data, so it stays usable after the Reaper below has run */
+static thread_local Block* lists[num_classes];
+static thread_local bool exited = false;
+
+/* hands this thread's free blocks to the shared pool when it exits */
+struct Reaper {
+    ~Reaper(void) {
+        Shared& s = shared();
+        lock_guard<mutex> guard(s.lock);
+        for (size_t k = 0; k < num_classes; ++k) {
+            while (Block* b = lists[k]) {
+                lists[k] = b->next;
+                b->next = s.spare[k];
+                s.spare[k] = b;
+            }
+        }
+        exited = true;
+    }
+};
+static thread_local Reaper reaper;
+
+/* the list for class k is empty: take the shared spares, or cut a slab */
+static void refill(size_t k) {
+    (void) &reaper;             // make sure this thread has one (see deallocate)
+    size_t block_size = (k + 1) * granule;
+    Shared& s = shared();
+    lock_guard<mutex> guard(s.lock);
+    if (s.spare[k]) {
+        lists[k] = s.spare[k];
+        s.spare[k] = nullptr;
+        return;
+    }
+    char* slab = static_cast<char*>(::operator new(slab_size));
+    s.slabs.push_back(slab);
+    /* link them so that the first block is handed out first */
+    Block* head = nullptr;
+    for (size_t n = slab_size / block_size; n-- > 0; ) {
+        Block* b = reinterpret_cast<Block*>(slab + n * block_size);
+        b->next = head;
+        head = b;
+    }
+    lists[k] = head;
+}
+#endif /* LIFEFORM_POOL */
+
+void* allocate(size_t n) {
+#if LIFEFORM_POOL
+    if (n <= max_size) {
+        size_t k = size_class(n);
+        if (exited) {           // (only while the thread is going away)
+            Shared& s = shared();
+            lock_guard<mutex> guard(s.lock);
+            if (Block* b = s.spare[k]) {
+                s.spare[k] = b->next;
+                return b;
+            }
+            return ::operator new((k + 1) * granule); // a whole block, it may be recycled
+        }
+        if (!lists[k]) { refill(k); }
+        Block* b = lists[k];
+        lists[k] = b->next;
+        return b;
+    }
+#endif /* LIFEFORM_POOL */
+    return ::operator new(n);
+}
+
+void deallocate(void* p, size_t n) {
+#if LIFEFORM_POOL
+    if (n <= max_size) {
+        size_t k = size_class(n);
+        Block* b = static_cast<Block*>(p);
+        if (!exited) {
+            /* a thread that only frees (e.g., it drops the last reference
+               to LifeForms made elsewhere) needs a Reaper too, or its
+               list would be lost when it exits */
+            (void) &reaper;
+            b->next = lists[k];
+            lists[k] = b;
+        } else {
+            Shared& s = shared();
+            lock_guard<mutex> guard(s.lock);
+            b->next = s.spare[k];
+            s.spare[k] = b;
+        }
+        return;
+    }
+#endif /* LIFEFORM_POOL */
+    ::operator delete(p);
+}
+
+}
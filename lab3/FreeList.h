@@ -0,0 +1,35 @@
+#if !(_FreeList_h)
+#define _FreeList_h 1
+
+#include <cstddef>
+
+/*
+ * Size-class free lists for objects that are born and die all the time
+ * (LifeForms: see LifeForm::operator new).
+ *
+ * Sizes are rounded up to a multiple of 16 bytes; each of those size
+ * classes (up to max_size) has a free list per thread.  A freed block
+ * goes onto the front of its list and is the next one handed out, so
+ * births reuse memory that is still in the cache, and the objects of
+ * one size class sit together in 16K slabs instead of being spread
+ * over the general heap.  Allocating and freeing are a few instructions
+ * and never take a lock.
+ *
+ * Slabs are never given back to the system.  When a thread exits, its
+ * free blocks go to a shared pool (under a lock), which threads refill
+ * from before they cut up a new slab.  A block may be freed on a
+ * different thread than it was allocated on; it simply moves to that
+ * thread's list.
+ *
+ * Compile with -DLIFEFORM_POOL=0 to use plain new and delete instead
+ * (e.g., so that a sanitizer sees every object).
+ */
+namespace freelist {
+    const size_t granule = 16;
+    const size_t max_size = 1024;       // bigger objects use ::operator new
+
+    void* allocate(size_t);
+    void deallocate(void*, size_t);     // the same size allocate was given
+}
+
+#endif /* !(_FreeList_h) */
@@ -1,13 +1,37 @@
 #if !(_Init_h)
 #define _Init_h 1
 
+#if TYPE_DISPATCH
+#include <cstddef>
+#include <typeinfo>
+#include "LifeForm.h"
+#endif /* TYPE_DISPATCH */
+
 template <class T>
 class Initializer {
   int& count(void) { static int x = 0; return x; }
+
+#if TYPE_DISPATCH
+  /* T's TypeOps.  We are T's friend, so the qualified calls work even if
+     T's overrides are private */
+  static void colors(LifeForm* const* objs, size_t n, Color* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = static_cast<const T*>(objs[i])->T::my_color();
+    }
+  }
+  static void draw(LifeForm* const* objs, size_t n, const int* x, const int* y) {
+    for (size_t i = 0; i < n; ++i) {
+      static_cast<const T*>(objs[i])->T::draw(x[i], y[i]);
+    }
+  }
+#endif /* TYPE_DISPATCH */
 public:
   Initializer(void) { 
     if ((count())++ == 0) {
       T::initialize();
+#if TYPE_DISPATCH
+      LifeForm::add_type(TypeOps{ &typeid(T), &colors, &draw });
+#endif /* TYPE_DISPATCH */
     }
   }
 };
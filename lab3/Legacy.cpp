@@ -0,0 +1,142 @@
+#include <memory>
+#include <string>
+
+#include "Event.h"
+#include "Legacy.h"
+#include "ObjInfo.h"
+#include "Random.h"
+
+using namespace std;
+using legacy::Info;
+using legacy::Ops;
+using legacy::Proxy;
+using legacy::Sim;
+using legacy::Species;
+using legacy::State;
+using legacy::Task;
+
+Legacy::Legacy(Species* species, const Ops* ops) : species(species), ops(ops) {
+    ops->attach(species, proxy());
+}
+
+Legacy::~Legacy(void) {
+    ops->release(species);
+}
+
+void Legacy::state(State& s) const {
+    s.energy = energy_at(Event::now());
+    s.alive = is_alive;
+    s.course = course;
+    s.speed = speed;
+}
+
+Color Legacy::my_color(void) const {
+    return (Color) ops->color(species);
+}
+
+string Legacy::species_name(void) const {
+    return ops->species_name(species);
+}
+
+string Legacy::player_name(void) const {
+    return ops->player_name(species);
+}
+
+Action Legacy::encounter(const ObjInfo& info) {
+    Info i{ info.species.str().c_str(), info.health, info.distance,
+            info.bearing, info.their_speed, info.their_course };
+    return (Action) ops->encounter(species, i);
+}
+
+void Legacy::draw(int x, int y) const {
+    ops->draw(species, x, y);
+}
+
+void Sim::add_creator(const char* name, unsigned creator, const Ops* ops) {
+    LifeForm::add_creator([creator, ops](void) -> SmartPointer<LifeForm> {
+        return make_smart<Legacy>(ops->create(creator), ops);
+    }, name);
+}
+
+double Sim::now(void) {
+    return Event::now();
+}
+
+void Sim::state(Proxy* p, State& s) {
+    Legacy::of(p)->state(s);
+}
+
+bool Sim::is_alive(Proxy* p) {
+    State s;
+    Legacy::of(p)->state(s);
+    return s.alive;
+}
+
+void Sim::set_course(Proxy* p, double c) {
+    SmartPointer<LifeForm> self(Legacy::of(p));     // it may die here
+    Legacy::of(p)->set_course(c);
+}
+
+void Sim::set_speed(Proxy* p, double s) {
+    SmartPointer<LifeForm> self(Legacy::of(p));     // it may die here
+    Legacy::of(p)->set_speed(s);
+}
+
+void Sim::perceive(Proxy* p, double range, void (*add)(void*, const Info&), void* list) {
+    SmartPointer<LifeForm> self(Legacy::of(p));     // it may die here
+    for (const ObjInfo& info : Legacy::of(p)->perceive(range)) {
+        Info i{ info.species.str().c_str(), info.health, info.distance,
+                info.bearing, info.their_speed, info.their_course };
+        add(list, i);
+    }
+}
+
+void Sim::reproduce(Proxy* p, Species* child, const Ops* ops) {
+    SmartPointer<LifeForm> self(Legacy::of(p));     // it may die here
+    Legacy::of(p)->reproduce(make_smart<Legacy>(child, ops));
+}
+
+void Sim::draw(Proxy* p, int x, int y) {
+    Legacy::of(p)->LifeForm::draw(x, y);
+}
+
+void Sim::display(Proxy* p) {
+    Legacy::of(p)->display();
+}
+
+void Sim::renamed(Proxy* p) {
+    Legacy::of(p)->invalidate_species_id();
+}
+
+namespace {
+    /* an old Event, until the Event that runs it has happened or been
+       cancelled (the handler is copied, so it is shared) */
+    class Pending {
+        Task* task;
+        Species* holder;
+        const Ops* ops;
+
+        Pending(const Pending&) = delete;
+        void operator=(const Pending&) = delete;
+    public:
+        Pending(Task* task, Species* holder, const Ops* ops)
+            : task(task), holder(holder), ops(ops) {}
+        ~Pending(void) { ops->drop(task, holder); }
+        void run(void) { ops->run(task, holder); }
+    };
+}
+
+void Sim::schedule(Task* task, double t, Species* holder, Proxy* owner, const Ops* ops) {
+    shared_ptr<Pending> pending = make_shared<Pending>(task, holder, ops);
+    new Event(t - Event::now(), [pending](void) { pending->run(); },
+              owner ? Legacy::of(owner) : nullptr);
+}
+
+/*
+ * legacy/rename.sh sends the old objects' drand48, lrand48 and mrand48
+ * here, so that they draw from the current Simulation's generator (as
+ * everything else does) instead of the C library's
+ */
+extern "C" double legacy_drand48(void) { return epl::current_generator->uniform(); }
+extern "C" long legacy_lrand48(void) { return (long) (epl::current_generator->next() >> 33); }
+extern "C" long legacy_mrand48(void) { return (long) (int32_t) (epl::current_generator->next() >> 32); }
@@ -0,0 +1,37 @@
+#if !(_Legacy_h)
+#define _Legacy_h 1
+
+#include <string>
+
+#include "LifeForm.h"
+#include "legacy/Bridge.h"
+
+/*
+ * Class name: Legacy
+ * Description:
+ *  Stands in the simulation for an object of a species that was handed
+ *  in as an object file, built against the original LifeForm (see
+ *  legacy/Bridge.h).  What the simulator asks of a Legacy (encounter,
+ *  my_color, species_name, draw, ...) is asked of the old object, and
+ *  what the old object asks of its LifeForm (set_course, perceive,
+ *  reproduce, ...) is done by its Legacy, through legacy::Sim.
+ */
+class Legacy : public LifeForm {
+    legacy::Species* species;   // we hold a reference to it
+    const legacy::Ops* ops;
+
+    legacy::Proxy* proxy(void) { return reinterpret_cast<legacy::Proxy*>(this); }
+    static Legacy* of(legacy::Proxy* p) { return reinterpret_cast<Legacy*>(p); }
+    void state(legacy::State&) const;
+    friend struct legacy::Sim;
+public:
+    Legacy(legacy::Species*, const legacy::Ops*);
+    ~Legacy(void);
+    Color my_color(void) const;
+    std::string species_name(void) const;
+    std::string player_name(void) const;
+    Action encounter(const ObjInfo&);
+    void draw(int, int) const;
+};
+
+#endif /* !(_Legacy_h) */
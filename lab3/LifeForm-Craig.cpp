@@ -10,6 +10,7 @@
 
 #include "tokens.h"
 #include "Params.h"
+#include "ParamsProfile.h"
 #include "Event.h"
 #include "Window.h"
 #include "ObjInfo.h"
@@ -17,14 +18,24 @@
 #include "QuadTree.h"
 #include "LifeForm.h"
 #include "Algae.h"
+#include "DensityMap.h"
+#include "FreeList.h"
+#include "PoissonDisk.h"
+#include "Renderer.h"
 #include "Random.h"
+#include "Simulation.h"
 
 #if defined (_MSC_VER)
 using namespace epl;
 #endif
 using namespace std;
 using String = std::string;
-double MAX_SIMULATION_TIME = 50000.0;
+
+typedef params::Active P;
+
+/* new LifeForms are placed with the simulation's generator
+   (they don't have a stream of their own until they exist) */
+static double spawn_rng(void) { return epl::drand48(); }
 
 /*
  * Implementation NOTE:
@@ -46,21 +57,85 @@ LFCreatorTable& LifeForm::istream_creators()
     return the_real_table;
 }
 
-QuadTree<SmartPointer<LifeForm>> LifeForm::space(0.0, 0.0, grid_max, grid_max);
-Canvas LifeForm::win(win_x_size, win_y_size);
+#if TYPE_DISPATCH
+static const uint32_t unknown_type = 0xffffffff;
+
+/* same trick as istream_creators */
+vector<TypeOps>& LifeForm::type_ops(void)
+{
+    static vector<TypeOps> the_real_ops;
+    return the_real_ops;
+}
+
+void LifeForm::add_type(const TypeOps& ops) {
+    type_ops().push_back(ops);
+}
 
-std::vector<LifeForm*> LifeForm::all_life;
+uint32_t LifeForm::type_index(void) const {
+    if (type_cache == unknown_type) {
+        const vector<TypeOps>& ops = type_ops();
+        const type_info& t = typeid(*this);
+        type_cache = ops.size();
+        for (uint32_t k = 0; k < ops.size(); ++k) {
+            if (*ops[k].type == t) {
+                type_cache = k;
+                break;
+            }
+        }
+    }
+    return type_cache;
+}
+
+/* a counting sort -- the order within a group is objs' order */
+void LifeForm::group_by_type(vector<LifeForm*>& objs, vector<uint32_t>& start) {
+    uint32_t groups = type_ops().size() + 1;
+    start.assign(groups + 1, 0);
+    for (LifeForm* k : objs) { start[k->type_index() + 1] += 1; }
+    for (uint32_t g = 1; g <= groups; ++g) { start[g] += start[g - 1]; }
+
+    /* kept from call to call (a redisplay is a few thousand objects) */
+    static thread_local vector<uint32_t> next;
+    static thread_local vector<LifeForm*> sorted;
+    next.assign(start.begin(), start.end() - 1);
+    sorted.resize(objs.size());
+    for (LifeForm* k : objs) { sorted[next[k->type_cache]++] = k; }
+    objs.swap(sorted);
+}
+#endif /* TYPE_DISPATCH */
 
 LifeForm::LifeForm(void) {
-    energy = start_energy;
+    energy = P::start_energy();
     course = speed = 0.0;         // stationary
     pos = Point(0, 0);
     is_alive = false;
     update_time = Event::now();
     reproduce_time = 0.0;
     border_cross_event = nullptr;
-    vector_pos = all_life.size();
-    all_life.push_back(this);
+    decision_event = nullptr;
+#if PARALLEL_DECISIONS
+    decided = queued = false;
+#endif /* PARALLEL_DECISIONS */
+    stepped = false;
+    income_limit = HUGE;
+    energy_time = Event::now();
+    threshold_event = nullptr;
+    species_cache = player_cache = SpeciesTable::invalid;
+#if TYPE_DISPATCH
+    type_cache = unknown_type;  // typeid(*this) is still LifeForm here
+#endif /* TYPE_DISPATCH */
+#if MEMORY_ACCOUNTING
+    memory_size = allocated_size ? allocated_size : sizeof(LifeForm);
+    allocated_size = 0;
+    memory_species = SpeciesTable::invalid;
+#endif /* MEMORY_ACCOUNTING */
+#if TRACE_EVENTS
+    object_id = Trace::new_object();
+#endif /* TRACE_EVENTS */
+#if PER_LIFEFORM_RNG
+    generator = Simulation::current().new_stream();
+#endif /* PER_LIFEFORM_RNG */
+    vector_pos = all_life().size();
+    all_life().push_back(this);
 }
 
 
@@ -70,13 +145,38 @@ LifeForm::~LifeForm(void) {
 #endif /* DEBUG */
 
     assert(!is_alive);
-    assert(all_life[vector_pos] == this);
+    assert(all_life()[vector_pos] == this);
 
     /* remove from all_life list */
-    LifeForm* last = all_life.back();
-    all_life[vector_pos] = last;
+    LifeForm* last = all_life().back();
+    all_life()[vector_pos] = last;
     last->vector_pos = vector_pos;
-    all_life.pop_back();
+    all_life().pop_back();
+
+#if MEMORY_ACCOUNTING
+    if (memory_species != SpeciesTable::invalid) {
+        memory::species_account(memory_species).discharge(1, memory_size);
+    }
+#endif /* MEMORY_ACCOUNTING */
+}
+
+#if MEMORY_ACCOUNTING
+thread_local size_t LifeForm::allocated_size = 0;
+#endif /* MEMORY_ACCOUNTING */
+
+void* LifeForm::operator new(size_t n) {
+#if MEMORY_ACCOUNTING
+    memory::charge(MEM_LIFEFORM, n);
+    allocated_size = n;         // for the constructor
+#endif /* MEMORY_ACCOUNTING */
+    return freelist::allocate(n);
+}
+
+void LifeForm::operator delete(void* p, size_t n) {
+#if MEMORY_ACCOUNTING
+    memory::discharge(MEM_LIFEFORM, n);
+#endif /* MEMORY_ACCOUNTING */
+    freelist::deallocate(p, n);
 }
 
 
@@ -84,12 +184,32 @@ String LifeForm::player_name(void) const {
     return species_name();
 }
 
+SpeciesID LifeForm::species_id(void) const {
+    if (species_cache == SpeciesTable::invalid) {
+        species_cache = SpeciesTable::intern(species_name());
+    }
+    return species_cache;
+}
+
+SpeciesID LifeForm::player_id(void) const {
+    if (player_cache == SpeciesTable::invalid) {
+        String name = player_name();
+        player_cache = SpeciesTable::intern(name.substr(0, name.find(':')));
+    }
+    return player_cache;
+}
+
 
 
+/*
+ * create_life reads the whole config first and then places everybody at
+ * once: poisson_disk makes all of the positions in one go (they come back
+ * shuffled, so each species is spread over the whole area), the tree is
+ * built in one pass by insert_all, and the initial events (the ones the
+ * species' constructors make, too) are scheduled in one Event::Batch
+ */
 void LifeForm::create_life(void)
 {
-    SmartPointer<LifeForm> obj;
-
     if (testMode) { runTests(); return; }
 
     string line;
@@ -100,6 +220,8 @@ void LifeForm::create_life(void)
     inFile.open("config.test");
 #endif
 
+    vector<pair<string, unsigned>> requests;
+    unsigned total = 0;
     while (!inFile.eof())
     {
         getline(inFile, line);
@@ -108,52 +230,91 @@ void LifeForm::create_life(void)
 
         if (tokens.size() == 2)
         {
-            IstreamCreator factory_fun = (istream_creators())[tokens[0]];
-            bool first = true;
-            int numCreated = stoi(tokens[1]);
-            for (int i = 0; i < numCreated; i++) {
-                obj = factory_fun();
-                SmartPointer<LifeForm> nearest;
-                do {
-                    obj->pos.ypos = drand48() * grid_max * 0.75 + grid_max / 8.0;
-                    obj->pos.xpos = drand48() * grid_max * 0.75 + grid_max / 8.0;
-                    if (first) {
-                        nearest = nullptr;
-                        first = false;
-                    }
-                    else {
-                        nearest = space.closest(obj->pos);
-                    }
-                } while (nearest
-                    && nearest->position().distance(obj->position()) <= encounter_distance);
+            unsigned numCreated = stoi(tokens[1]);
+            requests.push_back(make_pair(tokens[0], numCreated));
+            total += numCreated;
+        }
+    }
+
+    vector<Point> spots = poisson_disk(grid_max / 8.0, grid_max / 8.0,
+                                       grid_max * 7.0 / 8.0, grid_max * 7.0 / 8.0,
+                                       P::encounter_distance(), total, *epl::current_generator);
+    if (spots.size() < total) {
+        /* cut every species back by the same fraction */
+        cerr << "create_life: only room for " << spots.size()
+             << " of the " << total << " LifeForms\n";
+        for (auto& request : requests) {
+            request.second = (unsigned) ((double) request.second * spots.size() / total);
+        }
+    }
+
+    using Entry = QuadTree<SmartPointer<LifeForm>>::Entry;
+    vector<Entry> entries;
+    entries.reserve(spots.size());
+    {
+        Event::Batch batch;
+        for (const auto& request : requests) {
+            /* find, not [], so that the table is never modified here --
+               several simulations may be reading it at once */
+            auto creator = istream_creators().find(request.first);
+            if (creator == istream_creators().end()) {
+                cerr << "create_life: no LifeForm named " << request.first << "\n";
+                continue;
+            }
+            IstreamCreator factory_fun = creator->second;
+            for (unsigned i = 0; i < request.second && entries.size() < spots.size(); i++) {
+                SmartPointer<LifeForm> obj = factory_fun();
+                obj->pos = spots[entries.size()];
                 obj->start_point = obj->pos;
-                space.insert(obj, obj->pos, [obj]() { obj->region_resize(); });
-                (void) new Event(age_frequency, [obj](void) { obj->age(); });
-                obj->is_alive = true;
+                entries.push_back(Entry{ obj, obj->pos, [obj]() { obj->region_resize(); } });
+                obj->start_aging();
+                obj->birth();
             }
         }
     }
+    space().insert_all(entries);
 
-    redisplay_all();
-    win.display();
+    if (Simulation::current().has_window()) {
+        redisplay_all();
+        win().display();
+    }
     //cout << "continue?" << endl;
     //string x;
     //cin >> x;
     //if (x != string("Yes")) exit(0);
 }
 
+unsigned LifeForm::population(void) {
+    return space().size();
+}
+
+/*
+ * the totals are kept current by birth, die and adjust_energy, except
+ * for the energy ticks nobody has settled yet, which are added in at
+ * their species' rate -- so looking doesn't touch (or settle) anybody
+ */
+std::vector<SpeciesStats> LifeForm::species_totals(void) {
+    vector<SpeciesStats> totals = species_stats();
+    for (SpeciesStats& s : totals) {
+        if (s.alive > 0) { s.energy += s.unsettled(Event::now()); }
+    }
+    return totals;
+}
+
+unsigned LifeForm::num_life_forms(void) {
+    return all_life().size();
+}
+
 void LifeForm::add_creator(IstreamCreator f, const String& s) {
     (istream_creators())[s] = f;
 }
 
 int LifeForm::scale_x(double x) {
-    double rel_x = (double)x / (double)grid_max;
-    return (int)(rel_x * win_x_size);
+    return win().viewport().to_x(x);
 }
 
 int LifeForm::scale_y(double y) {
-    double rel_y = (double)y / (double)grid_max;
-    return (int)(rel_y * win_y_size);
+    return win().viewport().to_y(y);
 }
 
 void LifeForm::print(void) const {
@@ -168,18 +329,19 @@ void LifeForm::print_position(void) const {
 
 void LifeForm::display(void) const
 {
+    if (!Simulation::current().has_window()) return; // headless (e.g., a tournament run)
 #if DEBUG
     cout << "drawing LF at";
     cout << "(" << pos.xpos << "," << pos.ypos << ")";
 #endif /* DEBUG */
-    win.set_color(my_color());
+    win().set_color(my_color());
     draw(scale_x(pos.xpos), scale_y(pos.ypos));
 #if DEBUG
     cout << endl;
 #endif /* DEBUG */
 }
 
-typedef pair<String, double> Rank;
+typedef pair<SpeciesID, double> Rank;
 struct RankCompare {
     bool operator()(const Rank& x, const Rank& y) {
         return x.second > y.second;
@@ -187,99 +349,211 @@ struct RankCompare {
 };
 
 
-void LifeForm::redisplay_all(void) {
-    typedef map<String, double> SpeciesHT;
-    SpeciesHT species_table;
-    static int max_species = 0; // the maximum number of species ever.
+/* an RGBA density map of what 'tree' has inside the view */
+static void make_density_map(const QuadTree<SmartPointer<LifeForm>>& tree,
+                             const Viewport& view, vector<uint8_t>& rgba) {
+    DensityMap map(view);
+    tree.visit_density(map.cell_size(), view.left(), view.bottom(), view.right(), view.top(),
+                       [&map](const Point& p, unsigned n, const SmartPointer<LifeForm>& obj) {
+                           map.add(p.xpos, p.ypos, n, obj->my_color());
+                       });
+    map.to_rgba(rgba);
+}
 
-    win.clear();
-    uint32_t num_life = 0;
-    for (LifeForm* k : all_life) {
+void LifeForm::draw_density(void) {
+    Canvas& canvas = win();
+    vector<uint8_t> rgba;
+    make_density_map(space(), canvas.viewport(), rgba);
+    canvas.clear();
+    canvas.draw_image(0, 0, canvas.get_width(), canvas.get_height(), rgba.data());
+    canvas.flush();
+}
+
+/* the objects in the view, or the number of them */
+static vector<SmartPointer<LifeForm>> in_view(const QuadTree<SmartPointer<LifeForm>>& tree,
+                                              const Viewport& v) {
+    return tree.in_rect(v.left(), v.bottom(), v.right(), v.top());
+}
+
+static unsigned count_in_view(const QuadTree<SmartPointer<LifeForm>>& tree, const Viewport& v) {
+    return tree.count_in_rect(v.left(), v.bottom(), v.right(), v.top());
+}
+
+#if TYPE_DISPATCH
+void LifeForm::visible_by_type(const Viewport& v, vector<LifeForm*>& objs,
+                               vector<uint32_t>& start, vector<Color>& colors) {
+    /* space holds a reference to each of them, so plain pointers will do */
+    vector<SmartPointer<LifeForm>> visible = in_view(space(), v);
+    objs.clear();
+    objs.reserve(visible.size());
+    for (const SmartPointer<LifeForm>& k : visible) {
+        if (k->is_alive) { objs.push_back(k.get()); }
+    }
+    group_by_type(objs, start);
+
+    const vector<TypeOps>& ops = type_ops();
+    colors.resize(objs.size());
+    for (uint32_t g = 0; g < ops.size(); ++g) {
+        ops[g].colors(objs.data() + start[g], start[g + 1] - start[g], colors.data() + start[g]);
+    }
+    for (uint32_t i = start[ops.size()]; i < objs.size(); ++i) {
+        colors[i] = objs[i]->my_color();
+    }
+}
+#endif /* TYPE_DISPATCH */
+
+/*
+ * only the objects inside the window's viewport are visited (the QuadTree
+ * finds them), so a zoomed-in view costs what it shows
+ */
+void LifeForm::draw_all(void) {
+    const Viewport& view = win().viewport();
+    if (count_in_view(space(), view) > density_display_threshold) {
+        draw_density();
+        return;
+    }
+    win().clear();
+#if TYPE_DISPATCH
+    /* a type at a time (see TypeOps), and set_color only when the color
+       changes, which within a type it seldom does */
+    vector<LifeForm*> objs;
+    vector<uint32_t> start;
+    vector<Color> colors;
+    visible_by_type(view, objs, start, colors);
+    vector<int> x(objs.size()), y(objs.size());
+    for (size_t i = 0; i < objs.size(); ++i) {
+        x[i] = scale_x(objs[i]->pos.xpos);
+        y[i] = scale_y(objs[i]->pos.ypos);
+    }
+
+    const vector<TypeOps>& ops = type_ops();
+    for (uint32_t g = 0; g + 1 < start.size(); ++g) {
+        for (uint32_t i = start[g], j; i < start[g + 1]; i = j) {
+            for (j = i + 1; j < start[g + 1] && colors[j] == colors[i]; ++j) {}
+            win().set_color(colors[i]);
+            if (g < ops.size()) { ops[g].draw(&objs[i], j - i, &x[i], &y[i]); }
+            else {
+                for (uint32_t k = i; k < j; ++k) { objs[k]->draw(x[k], y[k]); }
+            }
+        }
+    }
+#else
+    for (const SmartPointer<LifeForm>& k : in_view(space(), view)) {
         if (k->is_alive) {
-            num_life += 1;
             k->display();
-            String name = k->player_name();
-            name = name.substr(0, name.find(':'));
-            if (species_table.find(name) == species_table.end()) {
-                species_table[name] = 0.0;
-            }
-            species_table[name] += k->energy;
 
             /* uncomment the next line to get accurate graphics at the expense
                  of slowing down the simulator */
                  //      k->update_position();
         }
     }
-    win.flush();
+#endif /* TYPE_DISPATCH */
+    win().flush();
+}
+
+/*
+ * record what a Renderer needs to draw s.view, so that it never has to
+ * look at the LifeForms themselves (they belong to the simulation
+ * thread).  The objects are drawn as usual, each by its own draw(), but
+ * on the off-screen Canvas, which only records the commands
+ */
+void LifeForm::take_snapshot(Snapshot& s) {
+    s.time = Event::now();
+    Simulation& sim = Simulation::current();
+    sim.record_frames(&s.drawing);
+    Viewport view = win().viewport();
+    win().viewport() = s.view;
+    draw_all();
+    win().viewport() = view;
+    sim.record_frames(nullptr);
+}
 
+void LifeForm::redisplay_all(void) {
+    draw_all();
+    print_summary();
+}
+
+void LifeForm::print_summary(void) {
 #if (SPECIES_SUMMARY)
-    cout << "\n\n\n";
-    cout << "At Time " << Event::now()
-        << " there are " << num_life << " / " << all_life.size() << " total life forms, ";
-    int count = 0;
+    uint32_t num_life = 0;
     vector<Rank> rankings;
-    for (const auto& i : species_table) {
-        rankings.push_back(Rank(i.first, i.second));
-        count += 1;
+    const vector<SpeciesStats> totals = species_totals();
+    for (SpeciesID id = 0; id < totals.size(); ++id) {
+        if (totals[id].alive > 0) {
+            num_life += totals[id].alive;
+            rankings.push_back(Rank(id, totals[id].energy));
+        }
     }
+    int count = rankings.size();
+
+    cout << "\n\n\n";
+    cout << "At Time " << Event::now()
+        << " there are " << num_life << " / " << all_life().size() << " total life forms, ";
     cout << "and " << count << " distinct species\n";
     cout << "There are " << Event::num_events()
         << " events (" << (double)Event::num_events()
         / (double)num_life << " events per life form)\n";
 
-    if (count > max_species) { max_species = count; }
     sort(rankings.begin(), rankings.end(), RankCompare());
     int specs = 0;
 
     for (const Rank& best : rankings) {
-        cout << "Species: " << best.first << " has total of "
-            << best.second << " energy\n";
+        const SpeciesStats& s = totals[best.first];
+        cout << "Species: " << SpeciesTable::name(best.first) << " has total of "
+            << best.second << " energy (" << s.alive << " alive, "
+            << s.births << " births, " << s.deaths << " deaths, "
+            << s.eats << " eats)\n";
         specs += 1;
-        if (specs >= max_species / 2) {  // draw line to indicate winners/losers
+        if (specs >= (int) max_species() / 2) {  // draw line to indicate winners/losers
             cout << "----------------------------------------";
             cout << "----------------------------------------\n";
             specs = -specs; // make sure the line is drawn only once
         }
     }
+#endif /* SPECIES_SUMMARY */
+}
 
-    if ((termination_strategy == RUN_TILL_HALF_EXTINCT && count <= max_species / 2)
-        || (termination_strategy == RUN_TILL_ONE_SPECIES_LEFT && count <= 2)
-        || Event::now() > MAX_SIMULATION_TIME) {
-        // abort the simulation
-        cout << "\t!!Simulation Complete at time " << Event::now() << " !!\n";
-        //cout << "hit CTRL-C to stop\n";  // uncomment if you want to see the
-        //sleep(1000);                     // final state of the graphics display
-        exit(0);
+/*
+ * cheap enough to call after every event: live_species and max_species
+ * are maintained by birth and die
+ */
+bool LifeForm::simulation_complete(void) {
+    Simulation& sim = Simulation::current();
+    uint32_t live = live_species();
+    if ((termination_strategy == RUN_TILL_HALF_EXTINCT && live <= max_species() / 2)
+        || (termination_strategy == RUN_TILL_ONE_SPECIES_LEFT && live <= 2)
+        || Event::now() > sim.max_time) {
+        if (sim.verbose) {
+            cout << "\t!!Simulation Complete at time " << Event::now() << " !!\n";
+        }
+        return true;
     }
-#endif /* SPECIES_SUMMARY */
+    return false;
 }
 
 void LifeForm::draw(int x, int y) const
 {
-    win.draw_rectangle(x, y, x + 4, y + 4);
+    win().draw_rectangle(x, y, x + 4, y + 4);
 }
 
 void LifeForm::clear_screen(void)
 {
-    win.clear();
+    win().clear();
 }
 
 
 void Algae::create_spontaneously(void)
 {
-    SmartPointer<Algae> a = new Algae;
-    SmartPointer<LifeForm> nearest;
-    do {
-        a->pos.ypos = drand48() * grid_max * 0.75 + grid_max / 8.0;
-        a->pos.xpos = drand48() * grid_max * 0.75 + grid_max / 8.0;
-        nearest = space.closest(a->pos);
-    } while (nearest && nearest->position().distance(a->position())
-        <= encounter_distance);
+    auto spot = space().sample_free_point(grid_max / 8.0, grid_max / 8.0,
+                                          grid_max * 7.0 / 8.0, grid_max * 7.0 / 8.0,
+                                          P::encounter_distance(), spawn_rng);
+    if (!spot.first) return;    // no room for another spore
 
-    a->start_point = a->pos;
-    space.insert(a, a->pos,
+    SmartPointer<Algae> a = make_smart<Algae>();
+    a->pos = space().insert(a, spot.second,
         [a](void) { a->region_resize(); });
-    a->is_alive = true;
+    a->start_point = a->pos;
+    a->birth();
 }
 
 
@@ -301,7 +575,53 @@ void LifeForm::die(void)
                   // which kills object 2 ('cause it's too weak)
                   // space.remove(obj1) returns
                   // resolve_encounter calls obj2->die();
-    space.remove(pos);
+    space().remove(pos);
+    SpeciesStats& s = stats();
+    s.alive -= 1;
+    s.deaths += 1;
+    s.energy -= energy;
+    s.rate -= tick_rate();              // our unsettled ticks die with us
+    s.rate_base -= tick_rate() * energy_time;
+    if (s.alive == 0) {
+        live_species() -= 1;
+        s.extinct_at = Event::now();
+        s.rate = s.rate_base = 0.0;     // no rounding left over
+    }
     is_alive = false;
+    /* none of our pending events (border cross, energy threshold, digestion, the
+       species' own) can do anything any more -- drop them now rather
+       than processing each one just to find that we're dead */
+    cancel_events();
+    border_cross_event = nullptr;
+    threshold_event = nullptr;
+    decision_event = nullptr;
+#if PARALLEL_DECISIONS
+    Simulation::current().decisions.drop(this);
+    decided = false;
+#endif /* PARALLEL_DECISIONS */
+}
+
+void LifeForm::birth(void)
+{
+    assert(!is_alive);
+    SpeciesStats& s = stats();
+    if (s.alive == 0) {
+        uint32_t& live = live_species();
+        live += 1;
+        if (live > max_species()) { max_species() = live; }
+    }
+    s.alive += 1;
+    s.births += 1;
+    s.energy += energy;
+    is_alive = true;
+    energy_time = Event::now();         // no ticks before we were born
+    s.rate += tick_rate();
+    s.rate_base += tick_rate() * energy_time;
+    update_threshold();
+    (void) species_id();                // look it up now -- perceives on other threads read it
+#if MEMORY_ACCOUNTING
+    memory_species = player_id();
+    memory::species_account(memory_species).charge(1, memory_size);
+#endif /* MEMORY_ACCOUNTING */
 }
 
@@ -6,11 +6,16 @@
 #include "ObjInfo.h"
 #include "QuadTree.h" 
 #include "Params.h"
+#include "ParamsProfile.h"
 #include "LifeForm.h"
 #include "Event.h"
+#include "Random.h"
+#include "Simulation.h"
 
 using namespace std;
 
+typedef params::Active P;
+
 template <typename T>
 void bound(T& x, const T& min, const T& max) {
 	assert(min < max);
@@ -22,11 +27,15 @@ void bound(T& x, const T& min, const T& max) {
 
 ObjInfo LifeForm::info_about_them(SmartPointer<LifeForm> neighbor) {
 	ObjInfo info;
+	Point here = position_at(Event::now());
+	Point there = neighbor->position_at(Event::now());
 
-	info.species = neighbor->species_name();
+	info.species = SpeciesName(neighbor->species_id());
 	info.health = neighbor->health();
-	info.distance = pos.distance(neighbor->position());
-	info.bearing = pos.bearing(neighbor->position());
+	info.distance = here.distance(there);
+	// extrapolated positions can coincide (e.g., mid-encounter), and
+	// Point::bearing is undefined for a zero-length vector
+	info.bearing = here == there ? neighbor->course : here.bearing(there);
 	info.their_speed = neighbor->speed;
 	info.their_course = neighbor->course;
 	return info;
@@ -38,6 +47,7 @@ ObjInfo LifeForm::info_about_them(SmartPointer<LifeForm> neighbor) {
 void LifeForm::border_cross(void) {
     if (!is_alive) return;
     border_cross_event = nullptr;
+    broad_phase().crossed();
     update_position();
     check_encounter();
     compute_next_move();
@@ -47,46 +57,173 @@ void LifeForm::border_cross(void) {
  *  the callback function for region resizes (invoked by the quadtree)
  */
 void LifeForm::region_resize(void) {
+#if TRACE_EVENTS
+    Trace::Span span(Trace::RESIZE, Event::now(), object_id, player_id());
+#endif /* TRACE_EVENTS */
     update_position();
     compute_next_move();
 }
 
 void LifeForm::eat(SmartPointer<LifeForm> that) {
+    stats().eats += 1;
     that->die();
-    energy -= eat_cost_function(this->energy, that->energy);
-    if (energy < min_energy) {
+    adjust_energy(-P::eat_cost_function(this->energy, that->energy));
+    if (energy < P::min_energy()) {
         die();
         return;
     }
-    double e = that->energy * eat_efficiency;
-    SmartPointer<LifeForm> self = SmartPointer<LifeForm>(this);
-    (void) new Event (digestion_time, [self, e](void){ self->gain_energy(e); });
+    double e = that->energy * P::eat_efficiency();
+    WeakPointer<LifeForm> self{ this };
+    (void) new Event (P::digestion_time(), [self, e](void){
+        if (auto p = self.lock()) { p->gain_energy(e); }
+    }, this);
 }
 
 void LifeForm::gain_energy(double e) {
     // this lifeform may die in digestion time
     if (!is_alive) return;
-    energy += e;
-    if (energy < min_energy) {
-        energy = 0;
+    adjust_energy(e);
+    if (energy < P::min_energy()) {
+        set_energy(0);
         die();
     }
 }
 
+/*
+ * the ticks are counted as if each were min_delta_time early, so that a
+ * tick that an event was scheduled for is always counted by that event
+ * (the event's time is now + delay, which can round either way)
+ */
+double LifeForm::EnergyTicks::count(SimTime from, SimTime to) const {
+    if (period <= 0 || to <= start) return 0;
+    double n_to = floor((to - start + P::min_delta_time()) / period);
+    double n_from = from <= start ? 0 : floor((from - start + P::min_delta_time()) / period);
+    return n_to > n_from ? n_to - n_from : 0;
+}
+
+SimTime LifeForm::EnergyTicks::after(SimTime t) const {
+    if (period <= 0) return HUGE;
+    double k = t < start ? 1 : floor((t - start + P::min_delta_time()) / period) + 1;
+    return start + k * period;
+}
+
+double LifeForm::energy_at(SimTime t) const {
+    if (!is_alive) return energy;
+    return energy + aging.amount * aging.count(energy_time, t)
+                  + income.amount * income.count(energy_time, t);
+}
+
+void LifeForm::settle_energy_slow(void) {
+    double delta = energy_at(Event::now()) - energy;
+    if (is_alive) {
+        /* the ticks since energy_time are no longer unsettled */
+        SpeciesStats& s = stats();
+        s.energy += delta;
+        s.rate_base += tick_rate() * (Event::now() - energy_time);
+    }
+    energy_time = Event::now();
+    energy += delta;
+}
+
+double LifeForm::tick_rate(void) const {
+    return (aging.period > 0 ? aging.amount / aging.period : 0.0)
+         + (income.period > 0 ? income.amount / income.period : 0.0);
+}
+
 /**
- *  subtract age_penalty from energy
+ *  subtract age_penalty from energy every age_frequency (from now on)
  */
-void LifeForm::age(void) {
-    if (!is_alive) return;
-    energy -= age_penalty;
-    if (energy > min_energy) {
-        SmartPointer<LifeForm> self = SmartPointer<LifeForm>(this);
-        (void) new Event(age_frequency, [self](void){ self->age(); });
+void LifeForm::start_aging(void) {
+    settle_energy();
+    double before = tick_rate();
+    aging.start = Event::now();
+    aging.period = P::age_frequency();
+    aging.amount = -P::age_penalty();
+    if (is_alive) {
+        SpeciesStats& s = stats();
+        s.rate += tick_rate() - before;
+        s.rate_base += (tick_rate() - before) * energy_time;
+        update_threshold();
     }
-    else {
-        energy = 0;
+}
+
+/*
+ * the first tick after energy_time at which we'd die of age (energy at
+ * or below min_energy after an aging tick) or go over income_limit (after
+ * an income tick), as if nothing else happened to us.  HUGE if never
+ */
+SimTime LifeForm::next_threshold(void) const {
+    if (income.period <= 0) {
+        if (aging.period <= 0 || aging.amount >= 0) return HUGE;
+        double k = ceil((energy - P::min_energy()) / -aging.amount);
+        SimTime first = aging.after(energy_time);
+        return k > 1 ? first + (k - 1) * aging.period : first;
+    }
+
+    /* both kinds of ticks: walk through them (an Algae takes a few dozen
+       ticks to double its energy) */
+    double e = energy;
+    SimTime next_age = aging.period > 0 ? aging.after(energy_time) : HUGE;
+    SimTime next_income = income.after(energy_time);
+    for (unsigned n = 0; n < 1000; ++n) {
+        if (next_income <= next_age) {
+            e += income.amount;
+            if (e > income_limit) return next_income;
+            next_income += income.period;
+        } else {
+            e += aging.amount;
+            if (e <= P::min_energy()) return next_age;
+            next_age += aging.period;
+        }
+    }
+    return min(next_age, next_income);  // nothing yet -- look again then
+}
+
+/*
+ * called whenever our energy changes.  If the threshold is now sooner,
+ * the event moves up.  If it is later, the event stays where it is: it
+ * finds nothing to do, and schedules the next one.  Below min_energy
+ * our caller is about to kill us anyway
+ */
+void LifeForm::update_threshold(void) {
+    if (energy < P::min_energy()) return;
+    SimTime t = next_threshold();
+    if (t >= HUGE) return;
+    if (threshold_event) {
+        if (t < threshold_event->time()) { threshold_event->reschedule(t - Event::now()); }
+        return;
+    }
+    WeakPointer<LifeForm> self{ this };
+    threshold_event = new Event(t - Event::now(), [self](void) {
+        if (auto p = self.lock()) { p->energy_threshold(); }
+    }, this);
+}
+
+void LifeForm::energy_threshold(void) {
+    threshold_event = nullptr;
+    if (!is_alive) return;
+    settle_energy();
+    if (aging.period > 0 && energy <= P::min_energy()) {
+        set_energy(0);
         die();
+        return;
     }
+    if (energy > income_limit) {
+        income_reached();
+        if (!is_alive) return;
+    }
+    update_threshold();
+}
+
+/**
+ *  extrapolate the position at time t from pos, update_time, course and
+ *  speed.  Read-only, so it is safe to call on somebody else.
+ */
+Point LifeForm::position_at(SimTime t) const {
+    double delta_time = t - update_time;
+    if (!is_alive || delta_time < P::min_delta_time()) return pos;
+    return Point(pos.xpos + cos(course) * delta_time * speed,
+                 pos.ypos + sin(course) * delta_time * speed);
 }
 
 /**
@@ -94,17 +231,15 @@ void LifeForm::age(void) {
  */
 void LifeForm::update_position(void) {
     double delta_time = Event::now() - this->update_time;
-    Point newpos;
     // don't update position if time less than min_delta_time
-    if (!is_alive || delta_time < min_delta_time) return;
+    if (!is_alive || delta_time < P::min_delta_time()) return;
     
     // calculate new position
-    newpos.xpos = pos.xpos + cos(course) * delta_time * speed;
-    newpos.ypos = pos.ypos + sin(course) * delta_time * speed;
+    Point newpos = position_at(Event::now());
     
     // go out of bound, die
-    if (space.is_out_of_bounds(newpos)) {
-        energy = 0;
+    if (space().is_out_of_bounds(newpos)) {
+        set_energy(0);
         die();
         return;
     }
@@ -113,16 +248,18 @@ void LifeForm::update_position(void) {
     if (newpos == pos) return;
     
     // lack of energy, die
-    energy -= movement_cost(speed, delta_time);
-    if (energy < min_energy) {
-        energy = 0;
+    adjust_energy(-P::movement_cost(speed, delta_time));
+    if (energy < P::min_energy()) {
+        set_energy(0);
         die();
         return;
     }
     
+    // neighbours are not moved when we look at them, so following one
+    // along the same line can bring us exactly onto its (stale) position --
+    // the tree then keeps us at the next point over
     update_time = Event::now();
-    space.update_position(pos, newpos);
-    pos = newpos;
+    pos = space().update_position(pos, newpos);
 }
 
 
@@ -133,22 +270,34 @@ void LifeForm::update_position(void) {
  *  on ourself with the closest object
  */
 void LifeForm::check_encounter(void) {
-    if (!is_alive) return;
-    auto closest_obj = space.closest(pos);
     update_position();
-    if( is_alive && closest_obj->is_alive && pos.distance(closest_obj->pos) < encounter_distance )
-        resolve_encounter(closest_obj);
+    if (!is_alive) return;
+    // the same query as perceive: only we moved, so the neighbours are
+    // looked for (and measured) where they are now, not where the tree
+    // last saw them
+    Point here = position_at(Event::now());
+    SmartPointer<LifeForm> closest_obj;
+    double closest_dist = P::encounter_distance();
+    for (const auto& obj : space().nearby(here, P::encounter_distance())) {
+        if (obj.get() == this || !obj->is_alive) continue;
+        double dist = here.distance(obj->position_at(Event::now()));
+        if (dist < closest_dist) {
+            closest_obj = obj;
+            closest_dist = dist;
+        }
+    }
+    if (closest_obj) resolve_encounter(closest_obj);
 }
 
 void LifeForm::resolve_encounter(SmartPointer<LifeForm> that) {
-    energy -= encounter_penalty;
-    that->energy -= encounter_penalty;
-    if (energy < min_energy) {
-        energy = 0;
+    adjust_energy(-P::encounter_penalty());
+    that->adjust_energy(-P::encounter_penalty());
+    if (energy < P::min_energy()) {
+        set_energy(0);
         die();
     }
-    if (that->energy < min_energy) {
-        energy = 0;
+    if (that->energy < P::min_energy()) {
+        set_energy(0);
         die();
     }
     
@@ -160,12 +309,14 @@ void LifeForm::resolve_encounter(SmartPointer<LifeForm> that) {
     auto that_act = that->encounter(this_info);
     
     if (this_act == LIFEFORM_EAT && that_act == LIFEFORM_EAT) {
-        auto rand1 = drand48();
-        auto rand2 = drand48();
-        if ( rand1 < eat_success_chance(energy, that->energy) && rand2 < eat_success_chance(that->energy, energy)) {
-            switch (encounter_strategy) {
+        double draws[3];        // one per attempt to eat, one for a tie break
+        uniform(draws, 3);
+        double rand1 = draws[0];
+        double rand2 = draws[1];
+        if ( rand1 < P::eat_success_chance(energy, that->energy) && rand2 < P::eat_success_chance(that->energy, energy)) {
+            switch (P::encounter_strategy()) {
                 case EVEN_MONEY:
-                    if (drand48() < 0.5) { eat(that); }
+                    if (draws[2] < 0.5) { eat(that); }
                     else { that->eat(SmartPointer<LifeForm>(this)); }
                     break;
                 case BIG_GUY_WINS:
@@ -188,22 +339,22 @@ void LifeForm::resolve_encounter(SmartPointer<LifeForm> that) {
                     break;
             }
         }
-        else if ( rand1 < eat_success_chance(energy, that->energy) && rand2 >= eat_success_chance(that->energy, energy) ) {
+        else if ( rand1 < P::eat_success_chance(energy, that->energy) && rand2 >= P::eat_success_chance(that->energy, energy) ) {
             eat(that);
         }
-        else if ( rand1 >= eat_success_chance(energy, that->energy) && rand2 < eat_success_chance(that->energy, energy)) {
+        else if ( rand1 >= P::eat_success_chance(energy, that->energy) && rand2 < P::eat_success_chance(that->energy, energy)) {
             that->eat(SmartPointer<LifeForm>(this));
         }
         else {}
         
     }
     else if ( this_act == LIFEFORM_EAT && that_act == LIFEFORM_IGNORE ) {
-        if (drand48() < eat_success_chance(energy, that->energy)) {
+        if (uniform() < P::eat_success_chance(energy, that->energy)) {
             eat(that);
         }
     }
     else if ( this_act == LIFEFORM_IGNORE && that_act == LIFEFORM_EAT ) {
-        if (drand48() < eat_success_chance(that->energy, energy)) {
+        if (uniform() < P::eat_success_chance(that->energy, energy)) {
             that->eat(SmartPointer<LifeForm>(this));
         }
     }
@@ -212,6 +363,7 @@ void LifeForm::resolve_encounter(SmartPointer<LifeForm> that) {
 
 /**
  *  a simple function that creates the next border_cross_event
+ *  (or, while the BroadPhase is stepping, has it move us instead)
  */
 void LifeForm::compute_next_move(void) {
     // cancel previous border_cross_event
@@ -220,11 +372,18 @@ void LifeForm::compute_next_move(void) {
         border_cross_event = nullptr;
     }
     
+    if (speed > 0.0 && broad_phase().is_stepped()) {
+        broad_phase().add_mover(this);
+        return;
+    }
+
     // schedule a new new border_cross event
-    SmartPointer<LifeForm> self = SmartPointer<LifeForm>(this);
     if (speed > 0.0) {
-        double delta_time = (space.distance_to_edge(pos, course) + Point::tolerance)/speed;
-        border_cross_event = new Event(delta_time, [self](void){ self->border_cross(); });
+        WeakPointer<LifeForm> self{ this };
+        double delta_time = (space().distance_to_edge(pos, course) + Point::tolerance)/speed;
+        border_cross_event = new Event(delta_time, [self](void){
+            if (auto p = self.lock()) { p->border_cross(); }
+        }, this);
     }
 }
 
@@ -237,7 +396,7 @@ void LifeForm::set_course(double c) {
 void LifeForm::set_speed(double s) {
     if (!is_alive) return;
     update_position();
-    speed = s < max_speed? s : max_speed;
+    speed = s < P::max_speed()? s : P::max_speed();
     compute_next_move();
 }
 
@@ -245,44 +404,42 @@ void LifeForm::reproduce(SmartPointer<LifeForm> child) {
     if (!is_alive) return;
     
     update_position();
+    settle_energy();
     
-    if (Event::now() - reproduce_time < min_reproduce_time) return;
+    if (Event::now() - reproduce_time < P::min_reproduce_time()) return;
+    
+    // place child in [encounter_distance, reproduce_dist] from parent,
+    // clear of everybody else.  The tree only knows where the neighbours
+    // were when they last moved, so also check where the closest one is
+    // now.  If there's no room, ignore the attempt to reproduce
+    auto rng = [this](void) { return uniform(); };
+    bool placed = false;
+    for (int i = 0; i < 5 && !placed; ++i) {
+        auto spot = space().sample_free_point(pos, P::encounter_distance(), P::reproduce_dist(),
+                                              P::encounter_distance(), rng);
+        if (!spot.first) return;
+        child->pos = spot.second;
+        double dist = HUGE;
+        SmartPointer<LifeForm> nearest = space().closest(child->pos);
+        if (nearest) { dist = nearest->position_at(Event::now()).distance(child->pos); }
+        placed = dist > P::encounter_distance();
+    }
+    if (!placed) return;
     
-    energy = child->energy = energy * (1 - reproduce_cost) / 2;
+    set_energy(energy * (1 - P::reproduce_cost()) / 2);
+    child->energy = energy;
     
-    if (energy < min_energy) {
+    if (energy < P::min_energy()) {
         child->energy = 0;
         child->is_alive = false;
-        energy = 0;
+        set_energy(0);
         die();
     }
     else {
-        SmartPointer<LifeForm> nearest;
-        // try 5 times, if all fail, ignore the attempt to reproduce
-        for (int i = 0 ; i < 5; ++i) {
-            // place child in [encouter_distance, reproduce_dist] from parent
-            // of courese child shoude be in bound
-            do {
-                double r = encounter_distance + drand48() * (reproduce_dist - encounter_distance);
-                double rad = drand48() * 2 * M_PI;
-                child->pos.xpos = pos.xpos + r * cos(rad);
-                child->pos.ypos = pos.ypos + r * sin(rad);
-            } while (space.is_out_of_bounds(child->pos));
-            
-            // if child's position is within other lifeform's encounter_distance
-            // fail this try
-            nearest = space.closest(child->pos);
-            if (nearest) {
-                nearest->update_position();
-                if (nearest->pos.distance(child->pos) > encounter_distance) break;
-            }
-            else break;
-        }
-        
+        child->pos = space().insert(child, child->pos, [child](void) { child->region_resize(); });
         child->start_point = child->pos;
-        space.insert(child, child->pos, [child](void) { child->region_resize(); });
-        (void) new Event(age_frequency, [child](void) { child->age(); });
-        child->is_alive = true;
+        child->start_aging();
+        child->birth();
         reproduce_time = Event::now();
     }
 }
@@ -290,25 +447,105 @@ void LifeForm::reproduce(SmartPointer<LifeForm> child) {
 ObjList LifeForm::perceive(double perceive_range) {
     if (!is_alive) return ObjList(0);
     
-    if (perceive_range > max_perceive_range) { perceive_range = max_perceive_range; }
-    else if (perceive_range < min_perceive_range) { perceive_range = min_perceive_range; }
+    if (perceive_range > P::max_perceive_range()) { perceive_range = P::max_perceive_range(); }
+    else if (perceive_range < P::min_perceive_range()) { perceive_range = P::min_perceive_range(); }
     
-    energy -= perceive_cost(perceive_range);
-    if (energy < min_energy) {
-        energy = 0;
-        die();
-        return ObjList(0);
+    if (deciding) {
+        // carry_out pays for it (this may be on another thread)
+        deciding->perceive_cost += P::perceive_cost(perceive_range);
+    } else {
+        adjust_energy(-P::perceive_cost(perceive_range));
+        if (energy < P::min_energy()) {
+            set_energy(0);
+            die();
+            return ObjList(0);
+        }
     }
     
-    vector<SmartPointer<LifeForm>> obj_vector = space.nearby(pos, perceive_range);
+    // looking at the neighbours must not move them (or charge them for
+    // moving), so use their extrapolated positions
+    Point here = position_at(Event::now());
+    vector<SmartPointer<LifeForm>> obj_vector = space().nearby(here, perceive_range);
     ObjList obj_info_vector(0);
-    for (auto obj : obj_vector) {
-        obj->update_position();
-        if (pos.distance(obj->pos) < perceive_range) {
+    for (const auto& obj : obj_vector) {
+        if (obj.get() == this) continue;
+        if (here.distance(obj->position_at(Event::now())) < perceive_range) {
             obj_info_vector.push_back(info_about_them(obj));
         }
     }
+#if PROFILE_EVENTS
+    if (deciding) { deciding->perceived.push_back(make_pair(perceive_range, (uint64_t) obj_info_vector.size())); }
+    else { Profile::perceived(perceive_range, obj_info_vector.size()); }
+#endif /* PROFILE_EVENTS */
     return obj_info_vector;
 }
 
+thread_local LifeForm::Decision* LifeForm::deciding = nullptr;
+
+void LifeForm::new_decision(SimTime delay) {
+    if (!is_alive) return;
+    if (decision_event) { decision_event->cancel(); }
+#if PARALLEL_DECISIONS
+    Simulation::current().decisions.drop(this);
+    decided = false;
+#endif /* PARALLEL_DECISIONS */
+    WeakPointer<LifeForm> self{ this };
+    decision_event = new Event(delay, [self](void) {
+        if (auto p = self.lock()) { p->decision_due(); }
+    }, this);
+#if PARALLEL_DECISIONS
+    Simulation::current().decisions.add(this);
+#endif /* PARALLEL_DECISIONS */
+}
+
+void LifeForm::decision_due(void) {
+    if (!is_alive) return;
+    Decision d;
+#if PARALLEL_DECISIONS
+    /* we may be the first decision due in a new window: make it and
+       every other one due by the end of the window now, as if it were
+       already their time (nothing in between is seen) */
+    Decisions& decisions = Simulation::current().decisions;
+    if (decision_window > 0 && !decided) {
+        decisions.decide_until(Event::now() + decision_window);
+    }
+    decisions.drop(this);
+    if (decided) {
+        decided = false;
+        swap(d, early);
+    }
+    else
+#endif /* PARALLEL_DECISIONS */
+    {
+        /* made at its own time: the perceives are paid for as they are
+           made, just as they would be in an event of the species' own */
+        decide(d);
+        if (!is_alive) return;      // it couldn't afford them
+    }
+    decision_event = nullptr;
+    carry_out(d);
+}
+
+void LifeForm::carry_out(Decision& d) {
+#if PROFILE_EVENTS
+    for (const auto& k : d.perceived) { Profile::perceived(k.first, k.second); }
+#endif /* PROFILE_EVENTS */
+    if (d.perceive_cost > 0) {
+        adjust_energy(-d.perceive_cost);
+        if (energy < P::min_energy()) {
+            set_energy(0);
+            die();
+            return;
+        }
+    }
+    if (d.new_course) { set_course(d.course); }
+    if (d.new_speed) { set_speed(d.speed); }
+    // (an encounter on the new course may have asked for one already)
+    if (d.next >= 0 && !decision_event) { new_decision(d.next); }
+    if (health() >= d.reproduce_at) {
+        SmartPointer<LifeForm> child = offspring();
+        if (child) { reproduce(child); }
+    }
+}
+
 
@@ -7,22 +7,38 @@
 #include <algorithm>
 #include <memory>
 #include <functional>
+#include <typeinfo>
 #ifdef _MSC_VER
 # include <time.h>
 #else
 #include <sys/time.h>
 # endif /* end #IF for Windows/Linux time.h file */
 
+#include "Event.h"
 #include "Params.h"
+#include "ParamsProfile.h"
 #include "Point.h"
+#include "Random.h"
+#include "MemoryAccount.h"
 #include "SmartPointer.h"
+#include "Species.h"
 
+#if PARALLEL_DECISIONS
+#if !(PER_LIFEFORM_RNG && SMARTPTR_ATOMIC)
+#error "PARALLEL_DECISIONS needs PER_LIFEFORM_RNG=1 and SMARTPTR_ATOMIC=1"
+#endif
+#include "Decisions.h"
+#endif /* PARALLEL_DECISIONS */
 
 /* forward declarations */
 class LifeForm;
 class istream;
 struct ObjInfo;
+#if MEMORY_ACCOUNTING
+typedef std::vector<ObjInfo, AccountingAllocator<ObjInfo, MEM_OBJINFO>> ObjList;
+#else
 typedef std::vector<ObjInfo> ObjList;
+#endif /* MEMORY_ACCOUNTING */
 template <typename Obj> class QuadTree;
 
 /* 
@@ -39,6 +55,9 @@ typedef std::map<std::string, IstreamCreator> LFCreatorTable;
  * The Canvas class is something we can draw on
  */
 class Canvas;
+class BroadPhase;
+struct Snapshot;                // see Renderer.h
+class Viewport;
 
 /*
  * We draw with Colors
@@ -47,15 +66,35 @@ class Canvas;
 
 class Event;
 
+#if TYPE_DISPATCH
+/*
+ * The loops Initializer<T> registers for species T (see Init.h).  Each
+ * is handed only objects whose dynamic type is exactly T, so inside the
+ * loop my_color and draw are direct (and inlinable) calls to T's
+ * versions instead of virtual calls.
+ */
+struct TypeOps {
+    const std::type_info* type;
+    void (*colors)(LifeForm* const* objs, size_t n, Color* out);
+    void (*draw)(LifeForm* const* objs, size_t n, const int* x, const int* y);
+};
+#endif /* TYPE_DISPATCH */
+
 enum Action {
   LIFEFORM_IGNORE,
   LIFEFORM_EAT
 };
 
-class LifeForm : public ControlBlock {
+/*
+ * A LifeForm owns the events it schedules (pass 'this' as the Event's
+ * owner), so that die() can cancel all of them at once
+ */
+class LifeForm : public ControlBlock, public EventOwner {
 private:
-	/* space is the global storage that represents the 2-dimensional simulation area */
-    static QuadTree<SmartPointer<LifeForm>> space;
+	/* space is the storage that represents the 2-dimensional simulation area.
+	 * It belongs to the current Simulation (as do all_life, species_stats,
+	 * live_species, max_species and win) -- see Simulation.h */
+    static QuadTree<SmartPointer<LifeForm>>& space(void);
 
 
     /* In order to perform the graphics output and to keep track of
@@ -79,9 +118,12 @@ private:
      * LifeForm object where it can find this in the all_life vector
      *
      */
-      static std::vector<LifeForm*> all_life;
+      static std::vector<LifeForm*>& all_life(void);
       uint32_t vector_pos;
 
+      /* finds the encounters between moving objects -- see BroadPhase.h */
+      static BroadPhase& broad_phase(void);
+
       /* istream_creators is a map, indexed by strings, and returning functions
        * the functions create the correct subtype of LifeForm
        * i.e., istream_creators["Craig"] returns a function. If you call that
@@ -95,16 +137,107 @@ private:
        */
       static LFCreatorTable& istream_creators(void);
 
+#if TYPE_DISPATCH
+      /* the TypeOps of every species, kept the same way as
+       * istream_creators.  type_cache is our index in it (looked up from
+       * typeid(*this) the first time it is needed), or type_ops().size()
+       * for a type that registered none -- a subclass of a species, or
+       * a species built without Init.h -- whose calls stay virtual */
+      static std::vector<TypeOps>& type_ops(void);
+      mutable uint32_t type_cache;
+      uint32_t type_index(void) const;
+
+      /* sorts objs by type_index; group k is objs[start[k]..start[k+1]) */
+      static void group_by_type(std::vector<LifeForm*>& objs, std::vector<uint32_t>& start);
+      /* the live objects in the view, grouped by type, and
+       * colors[i] = objs[i]->my_color() (a group at a time) */
+      static void visible_by_type(const Viewport&, std::vector<LifeForm*>& objs,
+                                  std::vector<uint32_t>& start, std::vector<Color>& colors);
+#endif /* TYPE_DISPATCH */
+
 
       static int scale_x(double); // scale_x and scale_y are used to position the pixel
-      static int scale_y(double); // in the window when drawing a LifeForm
+      static int scale_y(double); // in the window (through its viewport) when drawing a LifeForm
       void print_position(void) const; // print and print_position are provided for debugging purposes
       void print(void) const;
 
       double energy;
       bool is_alive;
 
+      /* species_name() and player_name() are virtual and return a fresh
+       * string on every call, so their IDs are looked up once (species_id
+       * at birth, before any other thread can perceive us) and remembered
+       * here.  A species whose name changes says so with
+       * invalidate_species_id() */
+      mutable SpeciesID species_cache;
+      mutable SpeciesID player_cache;
+
+      /* per-species totals, indexed by player_id().  Every change to
+       * 'energy' and 'is_alive' goes through adjust_energy, set_energy,
+       * birth and die so that these never need to be rebuilt */
+      static std::vector<SpeciesStats>& species_stats(void);
+      static uint32_t& live_species(void);     // species with at least one live LifeForm
+      static uint32_t& max_species(void);      // the most species ever alive at once
+      SpeciesStats& stats(void) const;
+      void adjust_energy(double delta) {
+          settle_energy();
+          energy += delta;
+          if (is_alive) {
+              stats().energy += delta;
+              update_threshold();
+          }
+      }
+      void set_energy(double e) {
+          settle_energy();
+          adjust_energy(e - energy);
+      }
+      void birth(void);         // put a placed LifeForm into the simulation
+
+      /* Aging and photosynthesis are not events.  Each is a series of
+       * ticks, a fixed amount of energy at start + k * period (k >= 1),
+       * and 'energy' is our energy at energy_time, without the ticks
+       * since then.  energy_at adds them up in closed form, and
+       * settle_energy puts them into 'energy' (anything that reads or
+       * changes 'energy' settles first -- adjust_energy does).  The one
+       * event left is threshold_event, at the first tick at which we
+       * would die of age or go over income_limit */
+      struct EnergyTicks {
+          SimTime start;
+          SimTime period;           // 0: there are none
+          double amount;
+          EnergyTicks(void) : start(0), period(0), amount(0) {}
+          double count(SimTime from, SimTime to) const; // ticks in (from, to]
+          SimTime after(SimTime t) const;               // the first tick after t
+      };
+      EnergyTicks aging;            // -age_penalty every age_frequency (see start_aging)
+      EnergyTicks income;           // e.g., photosynthesis (Algae)
+      double income_limit;          // income_reached is called at a tick above this
+      SimTime energy_time;
+      Event* threshold_event;
+
+      double energy_at(SimTime) const;
+      void settle_energy(void) {
+          if (energy_time != Event::now()) { settle_energy_slow(); }
+      }
+      void settle_energy_slow(void);
+      double tick_rate(void) const; // energy per unit time from aging and income
+      void start_aging(void);       // from now on
+      SimTime next_threshold(void) const;
+      void update_threshold(void);  // move threshold_event up to next_threshold
+      void energy_threshold(void);  // threshold_event's handler
+      virtual void income_reached(void) {}
+
+      /* see decide() */
+      Event* decision_event;        // the pending decision (null if none)
+      void decision_due(void);      // its handler
+#if PARALLEL_DECISIONS
+      bool decided;                 // 'early' is decision_event's decision
+      bool queued;                  // in the Decisions' queue, at queue_pos
+      DecisionQueue::iterator queue_pos;
+#endif /* PARALLEL_DECISIONS */
+
       Event* border_cross_event;    // pointer to the event for the next encounter with a boundary
+      bool stepped;                 // moved by the BroadPhase's steps instead
       void border_cross(void);		// the event handler function for the border cross event
 
       void region_resize(void);		// the callback function for region resizes (invoked by the quadtree)
@@ -122,7 +255,6 @@ private:
 
       void resolve_encounter(SmartPointer<LifeForm>);
       void eat(SmartPointer<LifeForm>);
-      void age(void);               // subtract age_penalty from energy
       void gain_energy(double);
       void update_position(void);   // calculate the current position for
 				    // an object.  If less than Time::tolerance
@@ -144,12 +276,49 @@ private:
       ObjInfo info_about_them(SmartPointer<LifeForm>);
 
       const Point& position() const { return pos; }
-
-      static Canvas win;
+      Point position_at(SimTime) const; // where we will be at that time if we
+                                // keep our course and speed.  Unlike
+                                // update_position, this does not touch the
+                                // QuadTree or charge for the movement
+
+      static Canvas& win(void);
+
+#if PER_LIFEFORM_RNG
+      /* every LifeForm draws from its own stream, so what happens to one
+       * LifeForm does not depend on how many draws everybody else made */
+      epl::Xoshiro256 generator;
+#endif /* PER_LIFEFORM_RNG */
+
+#if TRACE_EVENTS
+      uint64_t object_id;           // who we are in a trace (see Trace.h)
+#endif /* TRACE_EVENTS */
+
+#if MEMORY_ACCOUNTING
+      /* the size operator new was asked for (i.e., of the whole derived
+       * object), and the species it is charged to once it is born */
+      static thread_local size_t allocated_size;
+      uint32_t memory_size;
+      SpeciesID memory_species;
+#endif /* MEMORY_ACCOUNTING */
+public:
+      /* every species is allocated from size-class free lists (see
+       * FreeList.h).  The destructor is virtual, so operator delete is
+       * given the size of the most derived class, just like operator new */
+      static void* operator new(size_t);
+      static void operator delete(void*, size_t);
 protected:
+      /* uniform random numbers in [0, 1) for this LifeForm, from its own
+       * stream (PER_LIFEFORM_RNG) or the simulation's */
+#if PER_LIFEFORM_RNG
+      double uniform(void) { return generator.uniform(); }
+      void uniform(double* out, size_t n) { generator.fill(out, n); }
+#else
+      double uniform(void) { return epl::drand48(); }
+      void uniform(double* out, size_t n) { epl::drand48(out, n); }
+#endif /* PER_LIFEFORM_RNG */
       double health(void) const {
     	  if (!is_alive) { return 0.0; }
-    	  else { return energy / start_energy; }
+    	  else { return energy_at(Event::now()) / params::Active::start_energy(); }
       }
       void set_course(double);
       void set_speed(double);
@@ -157,26 +326,104 @@ protected:
       double get_speed(void) const { return speed; }
       void reproduce(SmartPointer<LifeForm>);
       ObjList perceive(double);
+      /* call when species_name() starts returning something else; the
+         new name is looked up right away */
+      void invalidate_species_id(void) { species_cache = SpeciesTable::intern(species_name()); }
+
+      /*
+       * A species that mostly looks around and then steers (e.g., Craig's
+       * hunt) can do that as a decision instead of an event of its own.
+       * new_decision(delay) schedules a call to decide() (replacing any
+       * pending one).  decide() only perceives and fills in the Decision;
+       * the Decision is then carried out in the order of the fields:
+       * pay for the perceives if they were made ahead of time (and die
+       * if that was too much), set the course and speed, schedule the
+       * next decision (unless, e.g., an encounter on the new course asked
+       * for one already) and reproduce offspring() if we are healthy
+       * enough.
+       *
+       * With -DPARALLEL_DECISIONS=1 and decision_window > 0 (see Params.h)
+       * the first decision due at time t makes every live LifeForm's
+       * decision due by t + decision_window up front, on decision_threads
+       * threads, while the rest of the world stands still (see
+       * Decisions.h).  Each one still sees the world extrapolated to its
+       * own time, and is carried out at its own time.  So decide() must
+       * not change anything but the Decision and this object's own
+       * fields, and must draw its random numbers from uniform()
+       */
+      struct Decision {
+          bool new_course;
+          double course;
+          bool new_speed;
+          double speed;
+          SimTime next;             // decide again this much later (< 0: never)
+          double reproduce_at;      // reproduce if health() is at least this
+          double perceive_cost;     // for the perceives so far
+#if PROFILE_EVENTS
+          std::vector<std::pair<double, uint64_t>> perceived; // (range, found) per perceive
+#endif /* PROFILE_EVENTS */
+          Decision(void) : new_course(false), course(0), new_speed(false), speed(0),
+                           next(-1), reproduce_at(HUGE), perceive_cost(0) {}
+          void steer(double c) { new_course = true; course = c; }
+          void go(double s) { new_speed = true; speed = s; }
+      };
+      void new_decision(SimTime delay);
+      virtual void decide(Decision&) {}
+      virtual SmartPointer<LifeForm> offspring(void) { return SmartPointer<LifeForm>(); }
+private:
+      static thread_local Decision* deciding; // the one decide() is filling in
+      void carry_out(Decision&);
+#if PARALLEL_DECISIONS
+      Decision early;               // made ahead of time (if decided)
+#endif /* PARALLEL_DECISIONS */
 
 public:
       LifeForm(void);
       virtual ~LifeForm(void);
 
       static void add_creator(IstreamCreator, const std::string&);
+#if TYPE_DISPATCH
+      static void add_type(const TypeOps&); // called by Initializer<T>
+#endif /* TYPE_DISPATCH */
       static void create_life();
       /* draw the lifeform on 'win' where x,y is upper left corner */
       virtual void draw(int, int) const;
       virtual Color my_color(void) const = 0;
 
       void display(void) const;
-      static void redisplay_all(void);
+      static void draw_all(void);       // clear win and draw every live LifeForm
+                                        // (or draw_density, for big populations)
+      static void draw_density(void);   // clear win and draw a density map
+      static void print_summary(void);  // the species ranking (if SPECIES_SUMMARY)
+      static void redisplay_all(void);  // draw_all and print_summary
+      static void take_snapshot(Snapshot&); // for a Renderer on another thread
+      static bool simulation_complete(void); // true once termination_strategy says stop
+
+      /* read-only views of the simulation for StatsStream and friends */
+      static std::vector<SpeciesStats> species_totals(void); // as of now (O(species))
+      static unsigned population(void);     // number of objects in space
+      static unsigned num_life_forms(void); // alive or dead
       static void clear_screen(void);
 
       virtual Action encounter(const ObjInfo&) = 0;
       virtual std::string species_name(void) const = 0;
       virtual std::string player_name(void) const;
 
+      SpeciesID species_id(void) const;   // interned species_name()
+      SpeciesID player_id(void) const;    // interned player_name() (up to any ':')
+
+#if PROFILE_EVENTS || TRACE_EVENTS
+      uint32_t cost_account(void) const { return player_id(); } // our events are charged to our player
+#endif /* PROFILE_EVENTS || TRACE_EVENTS */
+#if TRACE_EVENTS
+      uint64_t trace_object(void) const { return object_id; }
+#endif /* TRACE_EVENTS */
+
 friend class Algae;
+friend class Legacy;
+friend class BroadPhase;
+friend class Simulation;
+friend class Decisions;
 
 /*
  * the following functions are used by the test program(s) and should not be used by students (except, of course,
@@ -0,0 +1,62 @@
+#include "MemoryAccount.h"
+
+#if MEMORY_ACCOUNTING
+
+#include <iomanip>
+
+using namespace std;
+
+namespace memory {
+
+static MemoryAccount kinds[NUM_MEMORY_KINDS];
+static MemoryAccount species[max_species];
+
+static const char* kind_names[NUM_MEMORY_KINDS] = {
+    "LifeForm", "TreeNode", "Event", "Event handler", "ObjInfo"
+};
+
+MemoryAccount& account(MemoryKind k) { return kinds[k]; }
+
+MemoryAccount& species_account(SpeciesID id) {
+    return species[id < max_species ? id : max_species - 1];
+}
+
+unsigned num_accounts(void) {
+    return NUM_MEMORY_KINDS + min<unsigned>(SpeciesTable::size(), max_species);
+}
+
+const MemoryAccount& account(unsigned k) {
+    return k < NUM_MEMORY_KINDS ? kinds[k] : species[k - NUM_MEMORY_KINDS];
+}
+
+string account_name(unsigned k) {
+    if (k < NUM_MEMORY_KINDS) { return kind_names[k]; }
+    SpeciesID id = k - NUM_MEMORY_KINDS;
+    return "LifeForm:" + (id == max_species - 1 && SpeciesTable::size() > max_species
+                          ? string("(others)") : SpeciesTable::name(id));
+}
+
+void report(ostream& out, const vector<SpeciesStats>* alive) {
+    out << "\nMemory by kind\n";
+    out << setw(24) << left << "kind" << right
+        << setw(12) << "live" << setw(14) << "bytes"
+        << setw(12) << "peak" << setw(14) << "peak bytes"
+        << setw(14) << "allocations" << setw(10) << "alive" << "\n";
+    for (unsigned k = 0; k < num_accounts(); ++k) {
+        const MemoryAccount& a = account(k);
+        if (a.allocations == 0) { continue; }
+        out << setw(24) << left << account_name(k) << right
+            << setw(12) << a.count << setw(14) << a.bytes
+            << setw(12) << a.peak_count << setw(14) << a.peak_bytes
+            << setw(14) << a.allocations;
+        SpeciesID id = k - NUM_MEMORY_KINDS;
+        if (alive && k >= NUM_MEMORY_KINDS && id < alive->size()) {
+            out << setw(10) << (*alive)[id].alive;
+        }
+        out << "\n";
+    }
+}
+
+}
+
+#endif /* MEMORY_ACCOUNTING */
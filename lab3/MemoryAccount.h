@@ -0,0 +1,127 @@
+#if !(_MemoryAccount_h)
+#define _MemoryAccount_h 1
+
+/*
+ * Live memory accounting by kind of object (compile with
+ * -DMEMORY_ACCOUNTING=1).
+ *
+ * This is lab2's InstanceCounter, grown up: every kind of object has an
+ * account that counts the live objects and their bytes, and remembers
+ * the high-water marks of both.  There are three ways in:
+ *
+ *   Accounted<T, Kind>        a CRTP base; T's constructors and destructor
+ *                             charge sizeof(T) to Kind (TreeNode, Event)
+ *   AccountingAllocator<T, Kind>
+ *                             an allocator for containers (the ObjInfo
+ *                             vectors perceive returns); counts buffers
+ *   memory::charge/discharge  by hand, for things whose size is only known
+ *                             at run time (LifeForms, per species)
+ *
+ * The counters are process wide (relaxed atomics), so simulations on
+ * several threads add up.  LifeForms are also counted per species: a
+ * species whose object count stays well above its 'alive' count has dead
+ * LifeForms that nobody has let go of yet.
+ *
+ * With MEMORY_ACCOUNTING=0 the hooks are compiled out.
+ */
+#if MEMORY_ACCOUNTING
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Species.h"
+
+enum MemoryKind {
+    MEM_LIFEFORM,               // all LifeForms (see also the species accounts)
+    MEM_TREENODE,
+    MEM_EVENT,
+    MEM_HANDLER,                // the callables inside Events' std::functions
+    MEM_OBJINFO,                // perceive results
+    NUM_MEMORY_KINDS
+};
+
+struct MemoryAccount {
+    std::atomic<int64_t> count{ 0 }, bytes{ 0 };
+    std::atomic<int64_t> peak_count{ 0 }, peak_bytes{ 0 };
+    std::atomic<uint64_t> allocations{ 0 };
+
+    void charge(int64_t n, int64_t size) {
+        raise(peak_count, count.fetch_add(n, std::memory_order_relaxed) + n);
+        raise(peak_bytes, bytes.fetch_add(size, std::memory_order_relaxed) + size);
+        allocations.fetch_add(n, std::memory_order_relaxed);
+    }
+    void discharge(int64_t n, int64_t size) {
+        count.fetch_sub(n, std::memory_order_relaxed);
+        bytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+private:
+    static void raise(std::atomic<int64_t>& peak, int64_t x) {
+        int64_t old = peak.load(std::memory_order_relaxed);
+        while (x > old && !peak.compare_exchange_weak(old, x, std::memory_order_relaxed)) {}
+    }
+};
+
+namespace memory {
+    const unsigned max_species = 64;   // later species share the last account
+
+    MemoryAccount& account(MemoryKind);
+    MemoryAccount& species_account(SpeciesID);
+
+    inline void charge(MemoryKind k, size_t size) { account(k).charge(1, size); }
+    inline void discharge(MemoryKind k, size_t size) { account(k).discharge(1, size); }
+
+    /* for StatsStream: accounts 0 .. num_accounts()-1, the kinds first */
+    unsigned num_accounts(void);
+    const MemoryAccount& account(unsigned);
+    std::string account_name(unsigned);
+
+    /* a table of every account; with 'alive', also the live LifeForms of
+       each species (the rest of its objects are dead but not yet freed) */
+    void report(std::ostream&, const std::vector<SpeciesStats>* alive = nullptr);
+}
+
+/* the CRTP hook: class T : Accounted<T, KIND> { ... } */
+template <class T, MemoryKind Kind>
+class Accounted {
+public:
+    Accounted(void) { memory::charge(Kind, sizeof(T)); }
+    Accounted(const Accounted&) { memory::charge(Kind, sizeof(T)); }
+    Accounted& operator=(const Accounted&) { return *this; }
+    ~Accounted(void) { memory::discharge(Kind, sizeof(T)); }
+};
+
+/* the allocator hook */
+template <class T, MemoryKind Kind>
+struct AccountingAllocator {
+    typedef T value_type;
+
+    AccountingAllocator(void) {}
+    template <class U>
+    AccountingAllocator(const AccountingAllocator<U, Kind>&) {}
+    template <class U>
+    struct rebind { typedef AccountingAllocator<U, Kind> other; };
+
+    /* a container's buffer is one allocation, of n T's */
+    T* allocate(size_t n) {
+        memory::account(Kind).charge(1, n * sizeof(T));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) {
+        memory::account(Kind).discharge(1, n * sizeof(T));
+        ::operator delete(p);
+    }
+
+    template <class U>
+    bool operator==(const AccountingAllocator<U, Kind>&) const { return true; }
+    template <class U>
+    bool operator!=(const AccountingAllocator<U, Kind>&) const { return false; }
+};
+
+#endif /* MEMORY_ACCOUNTING */
+
+#endif /* !(_MemoryAccount_h) */
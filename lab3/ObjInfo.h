@@ -2,9 +2,12 @@
 #define _ObjInfo_h 1
 #include <string>
 
+#include "Species.h"
+
 //#include "Default_ops.h"
 struct ObjInfo {
-  std::string species;               // species of the object
+  SpeciesName species;          // species of the object (an interned ID
+                                // that still compares to std::string)
   double health;                // their health
   double distance;              // distance between us
   double bearing;               // course I can take to get where it is now
@@ -1,13 +1,22 @@
+#include <cstdlib>
+
 #include "Params.h"
+#include "ParamsProfile.h"
+
+/*
+ * The variables start out with the values of the Standard profile (see
+ * ParamsProfile.h), and the functions are the Standard ones
+ */
+typedef params::Standard P;
 
 /*
  * any time you successfully eat something, you pay this cost
  * NOTE: if the object you eat has 5 energy (or less) then you'll
  * lose energy by trying to eat them
  */
-double eat_cost_function(double, double)
+double eat_cost_function(double e1, double e2)
 {
-  return 5.0;
+  return P::eat_cost_function(e1, e2);
 }
 
 /*
@@ -24,18 +33,18 @@ double eat_cost_function(double, double)
  */
 double eat_success_chance(double e1, double e2)
 {
-  return std::max(.10, e1 / (e1 + e2));
+  return P::eat_success_chance(e1, e2);
 }
 
 /* time between when you eat and when you get the energy */
-const SimTime digestion_time = 5.0;
+SimTime digestion_time = P::digestion_time();
 
 /* If you eat an object with E energy, then after digestion you gain
    eat_efficiency * E more energy */
-const double eat_efficiency = 0.95;
+double eat_efficiency = P::eat_efficiency();
 
 /* the amount of energy a life form starts with */
-const double start_energy = 100.0;
+double start_energy = P::start_energy();
 
 /* 
  * it costs energy to exist, stationary, isolated objects eventually die
@@ -43,21 +52,21 @@ const double start_energy = 100.0;
  * the event should subtract age_penalty units of energy from the LifeForm
  * if the energy drops below min_energy, the LifeForm should die
  */
-const double age_penalty = 10;
-const double age_frequency = 100; // 0.1 unit of energy per unit time
+double age_penalty = P::age_penalty();
+double age_frequency = P::age_frequency(); // 0.1 unit of energy per unit time
 
 /* whether you eat or not, you take a penalty for colliding */
-const double encounter_penalty = 5.0;
+double encounter_penalty = P::encounter_penalty();
 
 /* the cost to move is non-linear */
 double movement_cost(double speed, double time)
 {
-  return 0.01 * pow(speed, 1.5) * time;
+  return P::movement_cost(speed, time);
 }
 
 
 /* all life forms must have at least this much energy, or they die */
-const double min_energy = 1.0 + eat_cost_function(1.0, 1.0);
+double min_energy = P::min_energy();
 
 /*
  * when a LifeForm reproduces, the child must be placed no further than
@@ -67,16 +76,16 @@ const double min_energy = 1.0 + eat_cost_function(1.0, 1.0);
  * NOTE: reproduce cost is a percentage, so the penalty
  * is energy * reproduce_cost
  */
-const double reproduce_dist = 5.0;
-const double reproduce_cost = 0.05;  // a fraction
-const double min_reproduce_time = 1.0;
+double reproduce_dist = P::reproduce_dist();
+double reproduce_cost = P::reproduce_cost();  // a fraction
+double min_reproduce_time = P::min_reproduce_time();
 /*
  * Algae gain energy automatically
  * Every algae_photo_time time units, an Algae gains Algae_energy_gain
  * units of energy
  */
-const double Algae_energy_gain = 2.0;
-const SimTime algae_photo_time = 5.0;
+double Algae_energy_gain = P::Algae_energy_gain();
+SimTime algae_photo_time = P::algae_photo_time();
 
 /*
  * two objects whos' centers are encounter_distance away (or closer)
@@ -96,7 +105,7 @@ const SimTime algae_photo_time = 5.0;
  * towards each other, collide once, and then turn and go opposite
  * directions.  (this case is very hard, solve it last)
  */
-const double encounter_distance = 1.0;
+double encounter_distance = P::encounter_distance();
 
 /*
  * every time an object attempts to look around, it should be assessed this
@@ -104,28 +113,37 @@ const double encounter_distance = 1.0;
  */
 
 double perceive_cost(double radius) {
-  return radius / 20.0;
+  return P::perceive_cost(radius);
 }
   
 /* objects must not be permitted to move faster than max_speed
  * if they do, then their speed should be set to max_speed (do not
  * kill them for trying)
  */
-const double max_speed = 10.0;
+double max_speed = P::max_speed();
 
 /* objects should not be permitted to percieve more than max_perceive_range
  * or perceive less than min_percieve_range.
  * If they do, adjust their perceive range to the appropriate bound
  * (do not kill them for trying)
  */
-const double max_perceive_range = 100.0;
-const double min_perceive_range = 2.0;
+double max_perceive_range = P::max_perceive_range();
+double min_perceive_range = P::min_perceive_range();
 
 const int grid_max = 500;
 const int win_x_size = 500;
 const int win_y_size = 500;
 
-const double min_delta_time = 1.0e-6; // minimum time between scheduling an
+unsigned density_display_threshold = 50000;
+
+double step_mode_enter = 0.5;
+double step_mode_leave = 0.25;
+SimTime step_mode_check_interval = 1.0;
+
+SimTime decision_window = 0.0;
+unsigned decision_threads = 0;
+
+double min_delta_time = P::min_delta_time(); // minimum time between scheduling an
                                 // event and when that event can occur
 
 /*
@@ -134,15 +152,87 @@ const double min_delta_time = 1.0e-6; // minimum time between scheduling an
  */
 
 /*
- * set your encounter resolution strategy here.  Only affects the
- * case where both objects want to eat each other and both objects
- * "succeed"
+ * the encounter resolution strategy (set it in the profile).  Only
+ * affects the case where both objects want to eat each other and both
+ * objects "succeed"
  */
-//const EncounterResolver encounter_strategy = FASTER_GUY_WINS;
-//const EncounterResolver encounter_strategy = EVEN_MONEY;
-const EncounterResolver encounter_strategy = BIG_GUY_WINS;
+EncounterResolver encounter_strategy = P::encounter_strategy();
 
-const SimulationTerminationStrategy termination_strategy =  
+SimulationTerminationStrategy termination_strategy =  
 // RUN_TILL_ONE_SPECIES_LEFT;
 // RUN_TILL_HALF_EXTINCT;
 RUN_TILL_EVENTS_EXHAUSTED;      // probably runs forever, Algae Spores
+
+/*
+ * the parameters set_param knows about
+ */
+namespace {
+  struct Setting {
+    const char* name;
+    double* number;             // or
+    unsigned* count;            // or
+    bool (*set)(const std::string&);
+    bool in_profile;            // read through params::Active
+  };
+
+  bool set_strategy(const std::string& s) {
+    static const char* names[] = { "EVEN_MONEY", "BIG_GUY_WINS", "UNDERDOG_IS_HERE",
+                                   "FASTER_GUY_WINS", "SLOWER_GUY_WINS" };
+    for (int k = 0; k < 5; ++k) { if (s == names[k]) { encounter_strategy = (EncounterResolver) k; return true; } }
+    return false;
+  }
+
+  bool set_termination(const std::string& s) {
+    static const char* names[] = { "RUN_TILL_HALF_EXTINCT", "RUN_TILL_ONE_SPECIES_LEFT",
+                                   "RUN_TILL_EVENTS_EXHAUSTED" };
+    for (int k = 0; k < 3; ++k) { if (s == names[k]) { termination_strategy = (SimulationTerminationStrategy) k; return true; } }
+    return false;
+  }
+
+  const Setting settings[] = {
+    { "digestion_time", &digestion_time, 0, 0, true },
+    { "eat_efficiency", &eat_efficiency, 0, 0, true },
+    { "start_energy", &start_energy, 0, 0, true },
+    { "age_penalty", &age_penalty, 0, 0, true },
+    { "age_frequency", &age_frequency, 0, 0, true },
+    { "encounter_penalty", &encounter_penalty, 0, 0, true },
+    { "min_energy", &min_energy, 0, 0, true },
+    { "reproduce_dist", &reproduce_dist, 0, 0, true },
+    { "reproduce_cost", &reproduce_cost, 0, 0, true },
+    { "min_reproduce_time", &min_reproduce_time, 0, 0, true },
+    { "Algae_energy_gain", &Algae_energy_gain, 0, 0, true },
+    { "algae_photo_time", &algae_photo_time, 0, 0, true },
+    { "encounter_distance", &encounter_distance, 0, 0, true },
+    { "max_speed", &max_speed, 0, 0, true },
+    { "max_perceive_range", &max_perceive_range, 0, 0, true },
+    { "min_perceive_range", &min_perceive_range, 0, 0, true },
+    { "density_display_threshold", 0, &density_display_threshold, 0, false },
+    { "step_mode_enter", &step_mode_enter, 0, 0, false },
+    { "step_mode_leave", &step_mode_leave, 0, 0, false },
+    { "step_mode_check_interval", &step_mode_check_interval, 0, 0, false },
+    { "decision_window", &decision_window, 0, 0, false },
+    { "decision_threads", 0, &decision_threads, 0, false },
+    { "min_delta_time", &min_delta_time, 0, 0, true },
+    { "encounter_strategy", 0, 0, set_strategy, true },
+    { "termination_strategy", 0, 0, set_termination, false },
+  };
+}
+
+bool set_param(const std::string& name, const std::string& value)
+{
+  for (const Setting& s : settings) {
+    if (name != s.name) continue;
+#if CONSTANT_PARAMS
+    if (s.in_profile) return false;     // compiled in
+#endif /* CONSTANT_PARAMS */
+    if (s.set) return s.set(value);
+
+    char* end;
+    double x = strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || !(x >= 0)) return false;
+    if (s.number) *s.number = x;
+    else *s.count = (unsigned) x;
+    return true;
+  }
+  return false;
+}
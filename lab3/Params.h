@@ -3,6 +3,7 @@
 
 #include <cmath>
 #include <algorithm>
+#include <string>
 #define ALGAE_SPORES 1
 
 #if defined(_AIX) && !defined(XLC_IS_STUPID) && !defined(__GNUG__)
@@ -11,9 +12,9 @@
 
 #include "SimTime.h"
 
-/*****************************************************/
-/* PLEASE SEE Params.cpp FOR ACTUAL PARAMETER VALUES */
-/*****************************************************/
+/**********************************************************/
+/* PLEASE SEE ParamsProfile.h FOR ACTUAL PARAMETER VALUES */
+/**********************************************************/
 
 /*
  * any time you successfully eat something, you pay this cost
@@ -37,14 +38,14 @@ double eat_cost_function(double notUsed0=0, double notUsed1=0);
 double eat_success_chance(double e1, double e2);
 
 /* time between when you eat and when you get the energy */
-extern const SimTime digestion_time;
+extern SimTime digestion_time;
 
 /* If you eat an object with E energy, then after digestion you gain
    eat_efficiency * E more energy */
-extern const double eat_efficiency;
+extern double eat_efficiency;
 
 /* the amount of energy a life form starts with */
-extern const double start_energy;
+extern double start_energy;
 
 /* 
  * it costs energy to exist, stationary, isolated objects eventually die
@@ -52,17 +53,17 @@ extern const double start_energy;
  * the event should subtract age_penalty units of energy from the LifeForm
  * if the energy drops below min_energy, the LifeForm should die
  */
-extern const double age_penalty;
-extern const double age_frequency; // 0.1 unit of energy per unit time
+extern double age_penalty;
+extern double age_frequency; // 0.1 unit of energy per unit time
 
 /* whether you eat or not, you take a penalty for colliding */
-extern const double encounter_penalty;
+extern double encounter_penalty;
 
 /* the cost to move is non-linear */
 double movement_cost(double speed, double time);
 
 /* all life forms must have at least this much energy, or they die */
-extern const double min_energy;
+extern double min_energy;
 
 /*
  * when a LifeForm reproduces, the child must be placed no further than
@@ -72,16 +73,16 @@ extern const double min_energy;
  * NOTE: reproduce cost is a percentage, so the penalty
  * is energy * reproduce_cost
  */
-extern const double reproduce_dist;
-extern const double reproduce_cost;  // a fraction
-extern const double min_reproduce_time;
+extern double reproduce_dist;
+extern double reproduce_cost;  // a fraction
+extern double min_reproduce_time;
 /*
  * Algae gain energy automatically
  * Every algae_photo_time time units, an Algae gains Algae_energy_gain
  * units of energy
  */
-extern const double Algae_energy_gain;
-extern const SimTime algae_photo_time;
+extern double Algae_energy_gain;
+extern SimTime algae_photo_time;
 
 /*
  * two objects whos' centers are encounter_distance away (or closer)
@@ -101,7 +102,7 @@ extern const SimTime algae_photo_time;
  * towards each other, collide once, and then turn and go opposite
  * directions.  (this case is very hard, solve it last)
  */
-extern const double encounter_distance;
+extern double encounter_distance;
 
 /*
  * every time an object attempts to look around, it should be assessed this
@@ -113,23 +114,43 @@ double perceive_cost(double radius);
  * if they do, then their speed should be set to max_speed (do not
  * kill them for trying)
  */
-extern const double max_speed;
+extern double max_speed;
 
 /* objects should not be permitted to percieve more than max_perceive_range
  * or perceive less than min_percieve_range.
  * If they do, adjust their perceive range to the appropriate bound
  * (do not kill them for trying)
  */
-extern const double max_perceive_range;
-extern const double min_perceive_range;
+extern double max_perceive_range;
+extern double min_perceive_range;
 
 extern const int grid_max;
 extern const int win_x_size;
 extern const int win_y_size;
 
+/* with more objects than this in space, the display is a density map
+ * (built from the QuadTree, one colour per pixel) instead of one
+ * rectangle per LifeForm */
+extern unsigned density_display_threshold;
+
+/* the hybrid broad phase (see BroadPhase.h): every check_interval, the
+ * movers switch to fixed time steps when they cross more than
+ * step_mode_enter QuadTree borders per step they would take, and back
+ * to border_cross events below step_mode_leave */
+extern double step_mode_enter;
+extern double step_mode_leave;
+extern SimTime step_mode_check_interval;
+
+/* with -DPARALLEL_DECISIONS=1 (see LifeForm::decide): the decisions due
+ * within decision_window of the first one are made together, on
+ * decision_threads threads (0: one per core).  A decision_window of 0
+ * makes each one at its own time, on the simulation's thread */
+extern SimTime decision_window;
+extern unsigned decision_threads;
+
 // minimum time between scheduling an
 // event and when that event can occur
-extern const double min_delta_time; 
+extern double min_delta_time; 
 
 /*
  * You may ignore the parameters after this line.  Just extra
@@ -150,7 +171,7 @@ enum EncounterResolver {
  * case where both objects want to eat each other and both objects
  * "succeed"
  */
-extern const EncounterResolver encounter_strategy;
+extern EncounterResolver encounter_strategy;
 
 enum SimulationTerminationStrategy {
   RUN_TILL_HALF_EXTINCT,
@@ -158,6 +179,20 @@ enum SimulationTerminationStrategy {
   RUN_TILL_EVENTS_EXHAUSTED     // runs forever if ALGAE_SPORES is on
 };
 
-extern const SimulationTerminationStrategy termination_strategy;
+extern SimulationTerminationStrategy termination_strategy;
+
+/*
+ * Every parameter except the size of the world (the space is built with
+ * it) can be changed while the program runs, e.g., for each run of a
+ * Sweep.  set_param sets one by name: the name of the variable, and a
+ * number or (for encounter_strategy and termination_strategy) the name
+ * of an enumerator.  It returns false if there's no such parameter, the
+ * value doesn't make sense, or (with CONSTANT_PARAMS) the parameter is
+ * compiled in (see ParamsProfile.h).
+ *
+ * NOTE: nothing stops one thread from changing a parameter while another
+ * one runs a simulation -- don't.
+ */
+bool set_param(const std::string& name, const std::string& value);
 
 #endif /* !(_Params_h) */
@@ -0,0 +1,93 @@
+#if !(_ParamsProfile_h)
+#define _ParamsProfile_h 1
+
+#include <cmath>
+
+#include "Params.h"
+
+/*
+ * Parameter profiles.
+ *
+ * A profile is a class with a static function for every parameter and
+ * cost function in Params.h.  The simulation core (LifeForm, Algae,
+ * Event, BroadPhase) reads the rules only through params::Active, so
+ * they can be compiled in:
+ *
+ *  - params::Standard has the values as constexpr functions, and the
+ *    cost functions inline, so the compiler can fold them into
+ *    update_position, perceive, resolve_encounter, ...
+ *  - params::Runtime has the same cost functions, but reads the values
+ *    from the variables in Params.cpp, which set_param (e.g., in a
+ *    Sweep) can change.
+ *
+ * Compile with -DCONSTANT_PARAMS=1 to make Standard the Active profile
+ * (set_param then refuses to change the parameters it has compiled in).
+ * To try other rules, copy Standard, change it, and make that the
+ * Active profile.  The variables in Params.cpp start out with the
+ * Standard values.
+ */
+namespace params {
+
+struct Standard {
+    /* time between when you eat and when you get the energy */
+    static constexpr SimTime digestion_time(void) { return 5.0; }
+    /* the fraction of what you eat that you get after digestion */
+    static constexpr double eat_efficiency(void) { return 0.95; }
+    static constexpr double start_energy(void) { return 100.0; }
+    static constexpr double age_penalty(void) { return 10; }
+    static constexpr double age_frequency(void) { return 100; } // 0.1 unit of energy per unit time
+    static constexpr double encounter_penalty(void) { return 5.0; }
+    static constexpr double reproduce_dist(void) { return 5.0; }
+    static constexpr double reproduce_cost(void) { return 0.05; } // a fraction
+    static constexpr double min_reproduce_time(void) { return 1.0; }
+    static constexpr double Algae_energy_gain(void) { return 2.0; }
+    static constexpr SimTime algae_photo_time(void) { return 5.0; }
+    static constexpr double encounter_distance(void) { return 1.0; }
+    static constexpr double max_speed(void) { return 10.0; }
+    static constexpr double max_perceive_range(void) { return 100.0; }
+    static constexpr double min_perceive_range(void) { return 2.0; }
+    static constexpr double min_delta_time(void) { return 1.0e-6; }
+    static constexpr EncounterResolver encounter_strategy(void) { return BIG_GUY_WINS; }
+
+    /* see Params.h for what these mean */
+    static constexpr double eat_cost_function(double, double) { return 5.0; }
+    static constexpr double eat_success_chance(double e1, double e2) {
+        return e1 / (e1 + e2) > .10 ? e1 / (e1 + e2) : .10;
+    }
+    static double movement_cost(double speed, double time) {
+        return 0.01 * speed * std::sqrt(speed) * time;      // 0.01 * speed^1.5 * time
+    }
+    static constexpr double perceive_cost(double radius) { return radius / 20.0; }
+    static constexpr double min_energy(void) { return 1.0 + eat_cost_function(1.0, 1.0); }
+};
+
+struct Runtime : Standard {
+    static SimTime digestion_time(void) { return ::digestion_time; }
+    static double eat_efficiency(void) { return ::eat_efficiency; }
+    static double start_energy(void) { return ::start_energy; }
+    static double age_penalty(void) { return ::age_penalty; }
+    static double age_frequency(void) { return ::age_frequency; }
+    static double encounter_penalty(void) { return ::encounter_penalty; }
+    static double reproduce_dist(void) { return ::reproduce_dist; }
+    static double reproduce_cost(void) { return ::reproduce_cost; }
+    static double min_reproduce_time(void) { return ::min_reproduce_time; }
+    static double Algae_energy_gain(void) { return ::Algae_energy_gain; }
+    static SimTime algae_photo_time(void) { return ::algae_photo_time; }
+    static double encounter_distance(void) { return ::encounter_distance; }
+    static double max_speed(void) { return ::max_speed; }
+    static double max_perceive_range(void) { return ::max_perceive_range; }
+    static double min_perceive_range(void) { return ::min_perceive_range; }
+    static double min_delta_time(void) { return ::min_delta_time; }
+    static EncounterResolver encounter_strategy(void) { return ::encounter_strategy; }
+    static double min_energy(void) { return ::min_energy; }
+};
+
+#if CONSTANT_PARAMS
+typedef Standard Active;
+#else
+typedef Runtime Active;
+#endif /* CONSTANT_PARAMS */
+
+}
+
+#endif /* !(_ParamsProfile_h) */
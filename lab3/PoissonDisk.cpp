@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "PoissonDisk.h"
+
+using namespace std;
+
+namespace {
+
+class Grid {
+    double xmin, ymin, xmax, ymax;
+    double min_dist;
+    double cell;
+    int cols, rows;
+    vector<int> cells;          // index into points, or -1
+public:
+    vector<Point> points;
+
+    Grid(double xmin, double ymin, double xmax, double ymax, double min_dist)
+        : xmin(xmin), ymin(ymin), xmax(xmax), ymax(ymax), min_dist(min_dist),
+          cell(min_dist / sqrt(2.0)) {
+        cols = (int) ceil((xmax - xmin) / cell) + 1;
+        rows = (int) ceil((ymax - ymin) / cell) + 1;
+        cells.assign((size_t) cols * rows, -1);
+    }
+
+    int col(const Point& p) const { return (int) ((p.xpos - xmin) / cell); }
+    int row(const Point& p) const { return (int) ((p.ypos - ymin) / cell); }
+
+    bool inside(const Point& p) const {
+        return p.xpos >= xmin && p.xpos < xmax && p.ypos > ymin && p.ypos <= ymax;
+    }
+
+    /* true iff p is inside and more than min_dist from every point */
+    bool fits(const Point& p) const {
+        if (!inside(p)) { return false; }
+        int c = col(p), r = row(p);
+        for (int j = max(r - 2, 0); j <= min(r + 2, rows - 1); ++j) {
+            for (int i = max(c - 2, 0); i <= min(c + 2, cols - 1); ++i) {
+                int k = cells[(size_t) j * cols + i];
+                if (k >= 0 && points[k].distance(p) <= min_dist) { return false; }
+            }
+        }
+        return true;
+    }
+
+    void add(const Point& p) {
+        cells[(size_t) row(p) * cols + col(p)] = points.size();
+        points.push_back(p);
+    }
+};
+
+}
+
+vector<Point> poisson_disk(double xmin, double ymin, double xmax, double ymax,
+                           double min_dist, unsigned count, epl::Xoshiro256& rng) {
+    Grid grid(xmin, ymin, xmax, ymax, min_dist);
+    grid.points.reserve(count);
+
+    /* dart throwing -- stop after a run of misses */
+    const unsigned max_misses = 64;
+    unsigned misses = 0;
+    while (grid.points.size() < count && misses < max_misses) {
+        Point p(xmin + rng.uniform() * (xmax - xmin), ymax - rng.uniform() * (ymax - ymin));
+        if (grid.fits(p)) {
+            grid.add(p);
+            misses = 0;
+        } else {
+            misses += 1;
+        }
+    }
+
+    /* Bridson: every point is "active" until 'tries' candidates
+       around it have all failed */
+    const unsigned tries = 30;
+    vector<unsigned> active(grid.points.size());
+    for (unsigned k = 0; k < active.size(); ++k) { active[k] = k; }
+    while (grid.points.size() < count && !active.empty()) {
+        unsigned a = (unsigned) (rng.uniform() * active.size());
+        Point center = grid.points[active[a]];
+        bool found = false;
+        for (unsigned t = 0; t < tries && !found; ++t) {
+            double r = min_dist * (1.0 + rng.uniform()) * (1.0 + 1e-9);
+            double rad = rng.uniform() * 2 * M_PI;
+            Point p(center.xpos + r * cos(rad), center.ypos + r * sin(rad));
+            if (grid.fits(p)) {
+                active.push_back(grid.points.size());
+                grid.add(p);
+                found = true;
+            }
+        }
+        if (!found) {
+            active[a] = active.back();
+            active.pop_back();
+        }
+    }
+
+    shuffle(grid.points.begin(), grid.points.end(), rng);
+    return grid.points;
+}
@@ -0,0 +1,29 @@
+#if !(_PoissonDisk_h)
+#define _PoissonDisk_h 1
+
+#include <vector>
+
+#include "Point.h"
+#include "Random.h"
+
+/*
+ * Return up to 'count' random points inside the rectangle
+ * [xmin, xmax) x (ymin, ymax], no two of which are closer than
+ * 'min_dist' (they are all more than min_dist apart).
+ *
+ * The points are kept in a spatial hash with cells of min_dist / sqrt(2),
+ * so a cell holds at most one point and a candidate is checked against
+ * the 5x5 block of cells around it -- O(1) per candidate.
+ *
+ * First, darts are thrown uniformly over the rectangle.  When they start
+ * missing (the rectangle is getting full) the gaps are filled in by
+ * Bridson's method: new points are tried in the ring [min_dist, 2 min_dist]
+ * around the points we already have.  The result is returned in random
+ * order, so consecutive runs of it are spread over the whole rectangle.
+ *
+ * If the rectangle can't hold 'count' points, fewer are returned.
+ */
+std::vector<Point> poisson_disk(double xmin, double ymin, double xmax, double ymax,
+                                double min_dist, unsigned count, epl::Xoshiro256& rng);
+
+#endif /* !(_PoissonDisk_h) */
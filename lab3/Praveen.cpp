@@ -31,15 +31,13 @@ String Praveen::species_name(void) const
 
 Action Praveen::encounter(const ObjInfo& info)
 {
-	if (info.species == species_name()) {
+	if (info.species.id() == species_id()) {
 		/* don't be cannibalistic */
 		set_course(info.bearing + M_PI);
 		return LIFEFORM_IGNORE;
 	}
 	else {
-		hunt_event->cancel();
-		SmartPointer<Praveen> me{this};
-		hunt_event = new Event(0.0, [me] (void) { me->hunt(); });
+		new_decision(0.0);
 		return LIFEFORM_EAT;
 	}
 }
@@ -56,9 +54,9 @@ void Praveen::initialize(void)
  */
 Praveen::Praveen()
 {
-		hunt_event = Nil<Event>();
-		SmartPointer<Praveen> me{this};
-		(void) new Event(0.0, [me] (void) { me->live();});
+		course_changed = 0;
+		WeakPointer<Praveen> me{this};
+		(void) new Event(0.0, [me] (void) { if (auto p = me.lock()) { p->live(); } }, this);
 }
 
 
@@ -66,10 +64,9 @@ Praveen::~Praveen()
 {
 }
 
-void Praveen::spawn(void)
+SmartPointer<LifeForm> Praveen::offspring(void)
 {
-	Praveen* child = new Praveen;
-	reproduce(child);
+	return SmartPointer<LifeForm>(new Praveen);
 }
 
 
@@ -97,18 +94,17 @@ LifeForm* Praveen::create(void)
  */
 void Praveen::live(void)
 {
-	set_course(drand48() * 2.0 * M_PI);
-	set_speed(2 + 5.0 * drand48());
-	SmartPointer<Praveen> me{this};
-	hunt_event = new Event(5.0, [me] (void) { me->hunt();});
+	set_course(uniform() * 2.0 * M_PI);
+	set_speed(2 + 5.0 * uniform());
+	new_decision(5.0);
 }
 
-void Praveen::hunt(void)
+/*
+ * hunt: head for the closest Algae.  If there is none, turn around (once)
+ */
+void Praveen::decide(Decision& d)
 {
-  const String fav_food = "Algae";
-
-  hunt_event = Nil<Event>();
-  if (health() == 0) { return; }
+  static const SpeciesID fav_food = SpeciesTable::intern("Algae");
 
   ObjList prey = perceive(40.0);
 
@@ -116,10 +112,10 @@ void Praveen::hunt(void)
   int count = 0 ;
   for (ObjInfo i : prey) {
     count++ ;
-    if (i.species == fav_food) {
+    if (i.species.id() == fav_food) {
       course_changed = 0 ;
       if (best_d > i.distance) {
-        set_course(i.bearing);
+        d.steer(i.bearing);
         best_d = i.distance;
       }
     }
@@ -127,12 +123,10 @@ void Praveen::hunt(void)
   if(best_d == HUGE){
      if(course_changed == 0){
        course_changed = 1 ;
-       set_course(get_course() + M_PI) ;
+       d.steer(get_course() + M_PI) ;
      }
   }
-  SmartPointer<Praveen> me{this};
-  hunt_event = new Event(10.0, [me] (void) { me->hunt();});
-
-   if (health() >= 4.0) spawn();
+  d.next = 10.0;
+  d.reproduce_at = 4.0;
 }
 
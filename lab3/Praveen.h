@@ -8,10 +8,9 @@ class Praveen : public LifeForm {
 protected:
   int course_changed ;
   static void initialize(void);
-  void spawn(void);
-  void hunt(void);
+  void decide(Decision&);       // hunt
+  SmartPointer<LifeForm> offspring(void);
   void live(void);
-  Event* hunt_event;
 public:
   Praveen(void);
   ~Praveen(void);
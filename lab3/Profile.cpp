@@ -0,0 +1,205 @@
+#include "Profile.h"
+
+#if PROFILE_EVENTS
+
+#include <algorithm>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#if PROFILE_PERF
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif /* PROFILE_PERF */
+
+#include "Species.h"
+
+using namespace std;
+
+namespace Profile {
+
+typedef pair<uint32_t, const type_info*> Key;
+
+/* the costs of every thread that has finished, and of the ones that
+   have reported */
+static mutex totals_lock;
+static map<Key, Cost>& totals(void) {
+    static map<Key, Cost> t;
+    return t;
+}
+
+static void add(Cost& to, const Cost& from) {
+    to.calls += from.calls;
+    to.seconds += from.seconds;
+    to.cycles += from.cycles;
+    to.instructions += from.instructions;
+    to.perceives += from.perceives;
+    to.perceived += from.perceived;
+    to.perceive_range += from.perceive_range;
+}
+
+/* one per thread; merged into the totals when the thread exits */
+struct Table {
+    map<Key, Cost> costs;
+    Cost* current = nullptr;    // the handler that is running
+    uint32_t account = NO_ACCOUNT;
+
+    void flush(void) {
+        lock_guard<mutex> guard(totals_lock);
+        for (auto& k : costs) { add(totals()[k.first], k.second); }
+        costs.clear();
+    }
+    ~Table(void) { flush(); }
+};
+
+static thread_local Table table;
+
+uint32_t current_account(void) { return table.account; }
+
+#if PROFILE_PERF
+/*
+ * user-space cycles and instructions for this thread, read together as
+ * one group.  If perf_event_open isn't allowed, the counts stay at 0
+ */
+class Counters {
+    int leader, follower;
+
+    static int open(uint64_t config, int group) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+    }
+public:
+    Counters(void) : follower(-1) {
+        leader = open(PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (leader >= 0) {
+            follower = open(PERF_COUNT_HW_INSTRUCTIONS, leader);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        } else {
+            static once_flag warned;
+            call_once(warned, [](void) {
+                cerr << "Profile: perf_event_open failed, no hardware counters\n";
+            });
+        }
+    }
+    ~Counters(void) {
+        if (follower >= 0) { close(follower); }
+        if (leader >= 0) { close(leader); }
+    }
+
+    void read(uint64_t& cycles, uint64_t& instructions) {
+        uint64_t values[3] = { 0, 0, 0 }; // count, then the counters
+        if (leader >= 0 && ::read(leader, values, sizeof(values)) > 0) {
+            cycles = values[1];
+            instructions = follower >= 0 ? values[2] : 0;
+        } else {
+            cycles = instructions = 0;
+        }
+    }
+};
+
+static thread_local Counters counters;
+#endif /* PROFILE_PERF */
+
+Dispatch::Dispatch(uint32_t account, const type_info& handler)
+    : prev(table.current), prev_account(table.account) {
+    table.current = &table.costs[Key(account, &handler)];
+    table.account = account;
+#if PROFILE_PERF
+    counters.read(start_cycles, start_instructions);
+#endif /* PROFILE_PERF */
+    start = chrono::steady_clock::now();
+}
+
+Dispatch::~Dispatch(void) {
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    Cost& c = *table.current;
+    c.calls += 1;
+    c.seconds += elapsed.count();
+#if PROFILE_PERF
+    uint64_t cycles, instructions;
+    counters.read(cycles, instructions);
+    c.cycles += cycles - start_cycles;
+    c.instructions += instructions - start_instructions;
+#endif /* PROFILE_PERF */
+    table.current = prev;
+    table.account = prev_account;
+}
+
+void perceived(double range, uint64_t found) {
+    if (!table.current) { return; } // not inside an event handler
+    table.current->perceives += 1;
+    table.current->perceived += found;
+    table.current->perceive_range += range;
+}
+
+static string handler_name(const type_info* t) {
+    int status = 0;
+    char* name = abi::__cxa_demangle(t->name(), nullptr, nullptr, &status);
+    string result = status == 0 ? name : t->name();
+    free(name);
+    return result;
+}
+
+void report(ostream& out, unsigned max_rows) {
+    table.flush();
+    vector<pair<Key, Cost>> rows;
+    double total = 0.0;
+    {
+        lock_guard<mutex> guard(totals_lock);
+        rows.assign(totals().begin(), totals().end());
+    }
+    for (auto& r : rows) { total += r.second.seconds; }
+    sort(rows.begin(), rows.end(), [](const pair<Key, Cost>& a, const pair<Key, Cost>& b) {
+        return a.second.seconds > b.second.seconds;
+    });
+
+    streamsize precision = out.precision();
+    out << "\nEvent handler costs (" << total << " s in handlers)\n";
+    out << setw(7) << "%time" << setw(12) << "seconds" << setw(11) << "calls"
+        << setw(10) << "us/call"
+#if PROFILE_PERF
+        << setw(12) << "cycles/call" << setw(11) << "insn/call"
+#endif /* PROFILE_PERF */
+        << setw(10) << "perceives" << setw(10) << "range" << setw(10) << "found"
+        << "  species: handler\n";
+    unsigned shown = 0;
+    for (auto& r : rows) {
+        if (shown++ == max_rows) { break; }
+        const Cost& c = r.second;
+        double calls = max<double>(c.calls, 1);
+        double perceives = max<double>(c.perceives, 1);
+        out << fixed << setprecision(1) << setw(7) << (total > 0 ? 100.0 * c.seconds / total : 0.0)
+            << setprecision(4) << setw(12) << c.seconds
+            << setw(11) << c.calls
+            << setprecision(2) << setw(10) << 1.0e6 * c.seconds / calls
+#if PROFILE_PERF
+            << setprecision(0) << setw(12) << c.cycles / calls
+            << setw(11) << c.instructions / calls
+#endif /* PROFILE_PERF */
+            << setw(10) << c.perceives
+            << setprecision(1) << setw(10) << c.perceive_range / perceives
+            << setw(10) << c.perceived / perceives
+            << "  " << (r.first.first == NO_ACCOUNT ? string("(none)") : SpeciesTable::name(r.first.first))
+            << ": " << handler_name(r.first.second) << "\n";
+    }
+    out.unsetf(ios::floatfield);
+    out.precision(precision);
+}
+
+}
+
+#endif /* PROFILE_EVENTS */
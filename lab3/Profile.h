@@ -0,0 +1,73 @@
+#if !(_Profile_h)
+#define _Profile_h 1
+
+/*
+ * Per-species cost accounting (compile with -DPROFILE_EVENTS=1).
+ *
+ * Event::do_next charges the time spent in every event handler to an
+ * account (the species of the event's owner, or -- for events without
+ * an owner -- the species whose handler scheduled it) and to the kind of
+ * handler (the type of the std::function's target, e.g., the lambda in
+ * Craig::hunt).  LifeForm::perceive adds its calls and result sizes to
+ * whatever handler is running.  With -DPROFILE_PERF=1 (Linux only) the
+ * CPU cycles and instructions retired are read from perf_event_open too.
+ *
+ * Every thread keeps its own table; report() merges them and prints the
+ * (species, handler) pairs, the most expensive first.
+ *
+ * With PROFILE_EVENTS=0 none of this is compiled at all.
+ */
+#include <cstdint>
+
+namespace Profile {
+const uint32_t NO_ACCOUNT = 0xffffffff; // same as SpeciesTable::invalid
+}
+
+#if PROFILE_EVENTS
+
+#include <chrono>
+#include <iostream>
+#include <typeinfo>
+
+namespace Profile {
+
+struct Cost {
+    uint64_t calls = 0;
+    double seconds = 0.0;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t perceives = 0;
+    uint64_t perceived = 0;     // objects returned by those perceives
+    double perceive_range = 0.0; // the sum of their ranges
+};
+
+/* the account of the handler running on this thread (or NO_ACCOUNT) */
+uint32_t current_account(void);
+
+/* charge one handler call (for the lifetime of the Dispatch) */
+class Dispatch {
+    Cost* prev;
+    uint32_t prev_account;
+    std::chrono::steady_clock::time_point start;
+#if PROFILE_PERF
+    uint64_t start_cycles, start_instructions;
+#endif /* PROFILE_PERF */
+
+    Dispatch(const Dispatch&) = delete;
+    void operator=(const Dispatch&) = delete;
+public:
+    Dispatch(uint32_t account, const std::type_info& handler);
+    ~Dispatch(void);
+};
+
+void perceived(double range, uint64_t found);
+
+/* the ranked table, for every thread so far (call it once the other
+   threads are done) */
+void report(std::ostream&, unsigned max_rows = 30);
+
+}
+
+#endif /* PROFILE_EVENTS */
+
+#endif /* !(_Profile_h) */
@@ -82,9 +82,12 @@
  */
 
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <utility>
 #include <vector>
+#include "MemoryAccount.h"
 #include "Point.h"
 
 template <class Obj> class TreeNode; // used for implementation of the QuadTree
@@ -100,6 +103,21 @@ class QuadTree {
                                 // this data, but having the copies of the 
                                 // boundary points is convenient
 
+  /* the search areas for sample_free_point.  Each can say whether a
+     region might overlap it, whether a point is inside, and make a quick
+     random guess */
+  struct Box { double left, right, bottom, top; };
+  struct Ring;
+  struct Rect;
+
+  template <class Area>
+  void free_leaves(const TreeNode<Obj>*, const Area&, double clearance,
+                   std::vector<Box>&) const;
+  template <class Area, class Rng>
+  std::pair<bool, Point> sample(const Area&, double clearance, Rng&) const;
+
+  Point free_key(Point) const;  // see insert
+
   /* COPYING is NOT YET DEFINED NOR PERMITTED */
   QuadTree(const QuadTree<Obj>&) { assert(0); }
   QuadTree<Obj>& operator=(const QuadTree<Obj>&) {
@@ -109,8 +127,13 @@ class QuadTree {
 public:
                                 // insert a *reference* to the object into the 
                                 // tree.  It is an error to insert an object
-                                // which 'is_out_of_bounds'.
-  void insert(const Obj&, const Point& pos, std::function<void(void)> = [](){});
+                                // which 'is_out_of_bounds'.  Two objects
+                                // can't be at the same point: if 'pos' is
+                                // occupied, the object goes to the next
+                                // free point along x.  Returns where it
+                                // went -- the point to remove it or move
+                                // it from
+  Point insert(const Obj&, const Point& pos, std::function<void(void)> = [](){});
 
   Obj remove(const Point&);
                                 // find the identical object 'x' in the tree
@@ -140,8 +163,75 @@ public:
   bool is_occupied(const Point&) const; // return true if the position is
                                 // already occupied by some other object
 
-  void update_position(const Point&, const Point&) ;
-  // updates position of object to new position
+  Point update_position(const Point&, const Point&) ;
+  // updates position of object to new position (which, as for insert,
+  // may be the next point over); returns where it went
+
+  unsigned size(void) const;    // the number of objects in the tree
+
+  void clear(void);             // remove every object (no callbacks are invoked)
+
+                                // one object for insert_all
+  struct Entry {
+    Obj obj;
+    Point pos;
+    std::function<void(void)> resize;
+  };
+
+  void insert_all(std::vector<Entry>&); // insert all of the objects at once.
+                                // Into an empty tree this is one O(n log n)
+                                // pass, with no splitting and no callbacks.
+                                // The vector is reordered
+
+                                // placement of new objects:
+                                // return a random point that is inside the
+                                // tree and more than 'clearance' away from
+                                // every object in it.  The point is taken
+                                // from the ring r_min <= distance <= r_max
+                                // about 'center' (or from the rectangle).
+                                // rng() must return a uniform double in
+                                // [0, 1).  first == false means there is
+                                // (almost certainly) no such point
+  template <class Rng>
+  std::pair<bool, Point> sample_free_point(const Point& center, double r_min, double r_max,
+                                           double clearance, Rng&& rng) const;
+  template <class Rng>
+  std::pair<bool, Point> sample_free_point(double xmin, double ymin, double xmax, double ymax,
+                                           double clearance, Rng&& rng) const;
+
+  bool is_clear(const Point&, double clearance) const; // true iff the point
+                                // is in bounds and no object is within
+                                // 'clearance' of it
+
+  std::vector<Obj> in_rect(double xmin, double ymin, double xmax, double ymax) const;
+                                // return a vector of the Objs inside the
+                                // rectangle [xmin, xmax] x [ymin, ymax]
+                                // (regions outside it are never visited)
+
+  unsigned count_in_rect(double xmin, double ymin, double xmax, double ymax) const;
+                                // the number of Objs in_rect would return,
+                                // without visiting the regions that are
+                                // entirely inside the rectangle
+
+                                // a level-of-detail walk for drawing: calls
+                                // visit(pos, count, obj) for every region
+                                // that is no bigger than cell x cell (or
+                                // holds a single object) and overlaps the
+                                // rectangle.  pos is the region's center
+                                // (the object's position if count == 1)
+                                // and obj is one of its objects.  Empty
+                                // regions are skipped, so the cost depends
+                                // on the area and 'cell', not on the
+                                // number of objects
+  template <class Visit>
+  void visit_density(double cell, double xmin, double ymin, double xmax, double ymax,
+                     Visit&& visit) const {
+    root->visit_density(cell, xmin, ymin, xmax, ymax, visit);
+  }
+  template <class Visit>
+  void visit_density(double cell, Visit&& visit) const {
+    root->visit_density(cell, uleft.xpos, lright.ypos, lright.xpos, uleft.ypos, visit);
+  }
    
 
   QuadTree(double xmin, double ymin, double xmax, double ymax) {
@@ -154,7 +244,11 @@ public:
 };
 
 template <class Obj> 
-class TreeNode {
+class TreeNode
+#if MEMORY_ACCOUNTING
+  : Accounted<TreeNode<Obj>, MEM_TREENODE>
+#endif /* MEMORY_ACCOUNTING */
+{
   typedef std::pair<bool, std::function<void(void)>> Result;
 
   Obj obj;                      // the object that is in this region
@@ -178,7 +272,8 @@ class TreeNode {
   unsigned num_objects;         // the number of objects inside this region
                                 // (including objects inside my children)
 
-  void split(void) {
+  /* create the four (empty) children of this region */
+  void make_children(void) {
     child = new TNPtr[4];
     double x = right() - left();
     double y = top() - bottom();
@@ -198,6 +293,10 @@ class TreeNode {
 
     /* 3th quadrant (lower right quad) */
     child[3] = new TreeNode<Obj>(uleft() + Point(halfx, -halfy), lright());
+  }
+
+  void split(void) {
+    make_children();
 
     unsigned k;                 // checked at end of "for" loop
     std::function<void(void)> dummy = [](){};           // not used
@@ -209,6 +308,9 @@ class TreeNode {
       }
     }
     assert(k < 4);
+    /* the child has the object now -- don't keep a second reference */
+    obj = Obj();
+    resize_event = std::function<void(void)>();
   }
 
   void merge() {
@@ -381,6 +483,7 @@ public:
       }
       assert(pos == obj_pos);
       oldobj = obj;
+      obj = Obj();
       resize_event = std::function<void(void)>();
       num_objects -= 1;
     }
@@ -408,6 +511,107 @@ public:
   }
 
 
+  /*
+   * fill this (empty leaf) region with the entries [first, last) in one
+   * pass: split the entries between the four children with
+   * std::partition and recurse.  No callbacks are invoked -- nobody was
+   * in the region before.  The entries must be inside this region and at
+   * distinct points
+   */
+  template <class Iter>
+  void build(Iter first, Iter last) {
+    assert(is_empty());
+    num_objects = last - first;
+    if (num_objects == 0) return;
+    if (num_objects == 1) {
+      assert(in_bounds(first->pos));
+      obj = first->obj;
+      obj_pos = first->pos;
+      resize_event = first->resize;
+      return;
+    }
+
+    make_children();
+    for (unsigned k = 0; k < 3; k++) {
+      TreeNode<Obj>* c = child[k];
+      Iter mid = std::partition(first, last,
+                                [c](const typename QuadTree<Obj>::Entry& e) { return c->in_bounds(e.pos); });
+      c->build(first, mid);
+      first = mid;
+    }
+    child[3]->build(first, last);
+  }
+
+  /* one of the objects in this (non-empty) region */
+  const Obj& any_object(void) const {
+    const TreeNode<Obj>* node = this;
+    while (node->num_objects > 1) {
+      unsigned k = 0;
+      while (node->child[k]->num_objects == 0) ++k;
+      node = node->child[k];
+    }
+    return node->obj;
+  }
+
+  /* the rectangle queries use closed rectangles [xmin, xmax] x [ymin, ymax] */
+  bool overlaps(double xmin, double ymin, double xmax, double ymax) const {
+    return left() <= xmax && right() >= xmin && bottom() <= ymax && top() >= ymin;
+  }
+
+  bool inside(double xmin, double ymin, double xmax, double ymax) const {
+    return left() >= xmin && right() <= xmax && bottom() >= ymin && top() <= ymax;
+  }
+
+  static bool in_rect(const Point& p, double xmin, double ymin, double xmax, double ymax) {
+    return p.xpos >= xmin && p.xpos <= xmax && p.ypos >= ymin && p.ypos <= ymax;
+  }
+
+  template <class Visit>
+  void visit_density(double cell, double xmin, double ymin, double xmax, double ymax,
+                     Visit& visit) const {
+    if (num_objects == 0) return;
+    if (! overlaps(xmin, ymin, xmax, ymax)) return;
+    if (num_objects == 1) {
+      if (in_rect(obj_pos, xmin, ymin, xmax, ymax)) visit(obj_pos, 1u, obj);
+    }
+    else if (right() - left() <= cell && top() - bottom() <= cell) {
+      Point center((left() + right()) / 2.0, (top() + bottom()) / 2.0);
+      visit(center, num_objects, any_object());
+    }
+    else {
+      for (unsigned k = 0; k < 4; k++) {
+        child[k]->visit_density(cell, xmin, ymin, xmax, ymax, visit);
+      }
+    }
+  }
+
+  void find_in_rect(std::vector<Obj>& list, double xmin, double ymin,
+                    double xmax, double ymax) const {
+    if (num_objects == 0) return;
+    if (! overlaps(xmin, ymin, xmax, ymax)) return;
+    if (num_objects == 1) {
+      if (in_rect(obj_pos, xmin, ymin, xmax, ymax)) list.push_back(obj);
+    }
+    else {
+      for (unsigned k = 0; k < 4; k++) {
+        child[k]->find_in_rect(list, xmin, ymin, xmax, ymax);
+      }
+    }
+  }
+
+  /* regions entirely inside the rectangle are counted without being visited */
+  unsigned count_in_rect(double xmin, double ymin, double xmax, double ymax) const {
+    if (num_objects == 0) return 0;
+    if (! overlaps(xmin, ymin, xmax, ymax)) return 0;
+    if (inside(xmin, ymin, xmax, ymax)) return num_objects;
+    if (num_objects == 1) return in_rect(obj_pos, xmin, ymin, xmax, ymax) ? 1 : 0;
+    unsigned result = 0;
+    for (unsigned k = 0; k < 4; k++) {
+      result += child[k]->count_in_rect(xmin, ymin, xmax, ymax);
+    }
+    return result;
+  }
+
   /*
    * return the vector of objects (not including one at 'center') that
    * are inside this region, and also not more than 'dist' units
@@ -526,14 +730,51 @@ QuadTree<Obj>::~QuadTree(void) {
 }
 
 template <class Obj>
-void QuadTree<Obj>::insert(const Obj& obj, const Point& pos, 
-                           std::function<void(void)> resize) {
+void QuadTree<Obj>::clear(void) {
+  TreeNode<Obj>* old = root;
+  root = new TreeNode<Obj>(uleft, lright);
+  delete old;
+}
+
+/*
+ * a region splits until each of its objects has a leaf of its own, so
+ * two objects at the same point would split it forever.  The second one
+ * is moved just far enough to be a different Point (== is to within
+ * Point::tolerance, and nearby and closest leave out the center): its x
+ * is stepped towards the middle of the tree, so it stays inside
+ */
+template <class Obj>
+Point QuadTree<Obj>::free_key(Point pos) const {
+  double middle = (uleft.xpos + lright.xpos) / 2.0;
+  double step = pos.xpos < middle ? 2 * Point::tolerance : -2 * Point::tolerance;
+  while (is_occupied(pos)) pos.xpos += step;
+  return pos;
+}
+
+template <class Obj>
+Point QuadTree<Obj>::insert(const Obj& obj, const Point& pos, 
+                            std::function<void(void)> resize) {
+  Point key = free_key(pos);
   std::function<void(void)> callback = [](){};
-  bool is_ok = root->insert(obj, pos, resize, callback);
+  bool is_ok = root->insert(obj, key, resize, callback);
   assert(is_ok);
   callback();
+  return key;
 }
          
+template <class Obj>
+void QuadTree<Obj>::insert_all(std::vector<Entry>& entries) {
+  if (root->num_objects == 0) {
+    for (const Entry& e : entries) assert(root->in_bounds(e.pos));
+    root->build(entries.begin(), entries.end());
+  } else {
+    for (const Entry& e : entries) insert(e.obj, e.pos, e.resize);
+  }
+#ifdef DEBUG_QUADTREE
+  root->check_tree();
+#endif /* DEBUG_QUADTREE */
+}
+
 template <class Obj>
 Obj QuadTree<Obj>::remove(const Point& pos) {
   std::function<void(void)> callback = [](){};
@@ -559,6 +800,25 @@ std::vector<Obj> QuadTree<Obj>::nearby(const Point& pos, double dist) const {
   return result;
 }
 
+template <class Obj>
+std::vector<Obj> QuadTree<Obj>::in_rect(double xmin, double ymin,
+                                        double xmax, double ymax) const {
+  std::vector<Obj> result;
+  root->find_in_rect(result, xmin, ymin, xmax, ymax);
+  return result;
+}
+
+template <class Obj>
+unsigned QuadTree<Obj>::count_in_rect(double xmin, double ymin,
+                                      double xmax, double ymax) const {
+  return root->count_in_rect(xmin, ymin, xmax, ymax);
+}
+
+template <class Obj>
+unsigned QuadTree<Obj>::size(void) const {
+  return root->num_objects;
+}
+
 template <class Obj>
 bool QuadTree<Obj>::is_out_of_bounds(const Point& pos) const {
   return ! root->in_bounds(pos);
@@ -605,11 +865,161 @@ bool QuadTree<Obj>::is_occupied(const Point& pos) const {
   return root->is_occupied(pos);
 }
 
+template <class Obj>
+bool QuadTree<Obj>::is_clear(const Point& pos, double clearance) const {
+  if (! root->in_bounds(pos)) return false;
+  if (root->is_occupied(pos)) return false; // closest() skips this object
+  double dist = clearance;
+  return ! root->closest(pos, dist).first;
+}
+
+template <class Obj>
+struct QuadTree<Obj>::Ring {
+  Point center;
+  double r_min, r_max;
+
+  Box bounds(void) const {
+    return Box{ center.xpos - r_max, center.xpos + r_max,
+                center.ypos - r_max, center.ypos + r_max };
+  }
+  bool contains(const Point& p) const {
+    double d = center.distance(p);
+    return d >= r_min && d <= r_max;
+  }
+  bool overlaps(const TreeNode<Obj>* node) const {
+    if (! node->intersects(center, r_max)) return false;
+    /* skip regions that are completely inside the hole */
+    return center.distance(node->uleft()) > r_min
+      || center.distance(node->lright()) > r_min
+      || center.distance(node->lleft()) > r_min
+      || center.distance(node->uright()) > r_min;
+  }
+  template <class Rng>
+  Point guess(Rng& rng) const {
+    double r = r_min + rng() * (r_max - r_min);
+    double rad = rng() * 2 * M_PI;
+    return Point(center.xpos + r * cos(rad), center.ypos + r * sin(rad));
+  }
+};
+
+template <class Obj>
+struct QuadTree<Obj>::Rect {
+  Box box;
+
+  Box bounds(void) const { return box; }
+  bool contains(const Point& p) const {
+    return p.xpos >= box.left && p.xpos <= box.right
+      && p.ypos >= box.bottom && p.ypos <= box.top;
+  }
+  bool overlaps(const TreeNode<Obj>* node) const {
+    return node->left() < box.right && node->right() > box.left
+      && node->bottom() < box.top && node->top() > box.bottom;
+  }
+  template <class Rng>
+  Point guess(Rng& rng) const {
+    return Point(box.left + rng() * (box.right - box.left),
+                 box.bottom + rng() * (box.top - box.bottom));
+  }
+};
+
+/*
+ * collect the leaves that overlap 'area' (clipped to the area's bounding
+ * box), except for occupied leaves that the occupant's clearance circle
+ * covers completely.  In a crowded neighbourhood the leaves are small, so
+ * most of them are dropped here
+ */
+template <class Obj>
+template <class Area>
+void QuadTree<Obj>::free_leaves(const TreeNode<Obj>* node, const Area& area,
+                                double clearance, std::vector<Box>& result) const {
+  if (! area.overlaps(node)) return;
+  if (! node->is_leaf()) {
+    for (unsigned k = 0; k < 4; k++)
+      free_leaves(node->child[k], area, clearance, result);
+    return;
+  }
+
+  Box outer = area.bounds();
+  Box clip{ std::max(node->left(), outer.left), std::min(node->right(), outer.right),
+            std::max(node->bottom(), outer.bottom), std::min(node->top(), outer.top) };
+  if (clip.left >= clip.right || clip.bottom >= clip.top) return;
+
+  if (node->num_objects == 1) {
+    const Point& p = node->obj_pos;
+    if (p.distance(Point(clip.left, clip.top)) <= clearance
+        && p.distance(Point(clip.right, clip.top)) <= clearance
+        && p.distance(Point(clip.left, clip.bottom)) <= clearance
+        && p.distance(Point(clip.right, clip.bottom)) <= clearance)
+      return;
+  }
+  result.push_back(clip);
+}
+
+/*
+ * Technique: first, a few plain guesses.  When the area is not crowded
+ * one of these almost always works, and each check is a closest() search
+ * that is cut off at 'clearance' (so it only visits a few nodes).
+ * If they all fail, list the leaves that could still hold a point and
+ * draw from those (weighted by their area), giving up after a bounded
+ * number of tries.  No leaves at all means there's definitely no room
+ */
+template <class Obj>
+template <class Area, class Rng>
+std::pair<bool, Point> QuadTree<Obj>::sample(const Area& area, double clearance,
+                                             Rng& rng) const {
+  const unsigned num_guesses = 4;
+  for (unsigned k = 0; k < num_guesses; k++) {
+    Point p = area.guess(rng);
+    if (is_clear(p, clearance)) return std::make_pair(true, p);
+  }
+
+  std::vector<Box> leaves;
+  free_leaves(root, area, clearance, leaves);
+  if (leaves.empty()) return std::make_pair(false, Point());
+
+  std::vector<double> total(leaves.size());
+  double sum = 0.0;
+  for (unsigned k = 0; k < leaves.size(); k++) {
+    sum += (leaves[k].right - leaves[k].left) * (leaves[k].top - leaves[k].bottom);
+    total[k] = sum;
+  }
+
+  unsigned tries = 2 * leaves.size() + 16;
+  for (unsigned k = 0; k < tries; k++) {
+    unsigned i = std::upper_bound(total.begin(), total.end(), rng() * sum) - total.begin();
+    if (i >= leaves.size()) i = leaves.size() - 1;
+    const Box& b = leaves[i];
+    /* top - u * height, never bottom (the bottom edge is outside a region) */
+    Point p(b.left + rng() * (b.right - b.left), b.top - rng() * (b.top - b.bottom));
+    if (area.contains(p) && is_clear(p, clearance)) return std::make_pair(true, p);
+  }
+  return std::make_pair(false, Point());
+}
+
+template <class Obj>
+template <class Rng>
+std::pair<bool, Point> QuadTree<Obj>::sample_free_point(const Point& center, double r_min,
+                                                        double r_max, double clearance,
+                                                        Rng&& rng) const {
+  return sample(Ring{ center, r_min, r_max }, clearance, rng);
+}
+
+template <class Obj>
+template <class Rng>
+std::pair<bool, Point> QuadTree<Obj>::sample_free_point(double xmin, double ymin,
+                                                        double xmax, double ymax,
+                                                        double clearance,
+                                                        Rng&& rng) const {
+  return sample(Rect{ Box{ xmin, xmax, ymin, ymax } }, clearance, rng);
+}
+
 
 template <class Obj>
-void QuadTree<Obj>::update_position(const Point& pos_old, 
-                                    const Point& pos_new) {
+Point QuadTree<Obj>::update_position(const Point& pos_old, 
+                                     const Point& wanted) {
   
+  if (wanted == pos_old) return pos_old;
+  const Point pos_new = free_key(wanted);
   std::pair<TreeNode<Obj>*, TreeNode<Obj>*> res = root->find_leaf(pos_old);
   TreeNode<Obj>* leaf = res.first;
   TreeNode<Obj>* parent = res.second;
@@ -671,6 +1081,7 @@ void QuadTree<Obj>::update_position(const Point& pos_old,
   root->check_tree();
 #endif /* DEBUG_QUADTREE */
 
+  return pos_new;
 }
 
 
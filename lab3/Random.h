@@ -1,8 +1,87 @@
-#include <random>
-
-#if defined (_MSC_VER)
-namespace epl {
-extern std::default_random_engine random_generator;
-extern std::function<double(void)> drand48;
-}
-#endif
+#if !(_Random_h)
+#define _Random_h 1
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace epl {
+
+/*
+ * Class name: Xoshiro256
+ * Description:
+ *  xoshiro256+ (Blackman & Vigna), a small, fast generator whose high 53
+ *  bits make good uniform doubles.  Everything is inline, so a draw costs
+ *  a handful of shifts and adds (std::function + std::bind, which we used
+ *  to have, cost an indirect call per draw).
+ *
+ *  The generator is seeded with a (seed, stream) pair.  Both are mixed
+ *  through splitmix64, so nearby seeds and stream numbers still give
+ *  unrelated sequences.  Use a different stream number for each
+ *  independent consumer (a simulation, a LifeForm, ...).
+ *
+ *  It also satisfies UniformRandomBitGenerator, so it can be handed to
+ *  the <random> distributions.
+ */
+class Xoshiro256 {
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed = 0, uint64_t stream = 0) { reseed(seed, stream); }
+
+    void reseed(uint64_t seed, uint64_t stream = 0) {
+        uint64_t x = seed;
+        x = splitmix64(x) ^ (stream * 0xd1342543de82ef95ULL);
+        for (uint64_t& word : s) { word = splitmix64(x); }
+    }
+
+    uint64_t next(void) {
+        const uint64_t result = s[0] + s[3];
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    /* a uniform double in [0, 1) */
+    double uniform(void) { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    /* the batch API: fill out[0..n-1] with uniform doubles */
+    void fill(double* out, size_t n) {
+        for (size_t k = 0; k < n; ++k) { out[k] = uniform(); }
+    }
+
+    static constexpr result_type min(void) { return 0; }
+    static constexpr result_type max(void) { return std::numeric_limits<uint64_t>::max(); }
+    result_type operator()(void) { return next(); }
+};
+
+/* the generator of the calling thread's current Simulation
+   (set by Simulation::Scope) */
+extern thread_local Xoshiro256* current_generator;
+
+/* a uniform draw from [0, 1) using the current Simulation's generator.
+   Always call it as epl::drand48 -- on POSIX systems an unqualified
+   drand48 is the C library's single, global generator */
+inline double drand48(void) { return current_generator->uniform(); }
+
+/* n draws at once */
+inline void drand48(double* out, size_t n) { current_generator->fill(out, n); }
+
+}
+
+#endif /* !(_Random_h) */
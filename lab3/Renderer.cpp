@@ -0,0 +1,64 @@
+#include <chrono>
+#include <thread>
+
+#include "LifeForm.h"
+#include "Params.h"
+#include "Renderer.h"
+#include "Window.h"
+
+using namespace std;
+
+Renderer::Renderer(double fps)
+    : done(false), drawn(0), fps(fps), view(grid_max, win_x_size, win_y_size) {}
+
+/*
+ * runs on the simulation thread
+ */
+void Renderer::publish(void) {
+    Snapshot& s = snapshots.write_buffer();
+    {
+        lock_guard<mutex> guard(view_lock);
+        s.view = view;
+    }
+    LifeForm::take_snapshot(s);
+    snapshots.publish();
+}
+
+void Renderer::set_view(const Viewport& v) {
+    lock_guard<mutex> guard(view_lock);
+    view = v;
+}
+
+/*
+ * runs on the main thread, which is the only one that calls FLTK
+ */
+void Renderer::run(void) {
+    Canvas canvas(win_x_size, win_y_size);
+    {
+        lock_guard<mutex> guard(view_lock);
+        canvas.viewport() = view;
+    }
+    canvas.on_view_change([this](const Viewport& v) { set_view(v); });
+    canvas.display();
+
+    const auto frame_time = chrono::microseconds{ (long) (1.0e6 / fps) };
+    for (;;) {
+        bool finished = done.load(memory_order_acquire);
+        if (snapshots.acquire()) {
+            const Snapshot& s = snapshots.read_buffer();
+            /* the commands were made with the snapshot's own view (the
+               Canvas's view is the one the user is changing, for the
+               next snapshot) */
+            canvas.clear();
+            s.drawing.replay(canvas);
+            canvas.flush();
+            drawn.fetch_add(1, memory_order_relaxed);
+        }
+        if (finished) { break; }
+        this_thread::sleep_for(frame_time);
+    }
+}
+
+void Renderer::close(void) {
+    done.store(true, memory_order_release);
+}
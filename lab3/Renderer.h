@@ -0,0 +1,69 @@
+#if !(_Renderer_h)
+#define _Renderer_h 1
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "Event.h"
+#include "FrameBuffer.h"
+#include "Params.h"
+#include "TripleBuffer.h"
+#include "Viewport.h"
+
+/*
+ * What the renderer needs to know about the world: the drawing commands
+ * for the view, as LifeForm::draw_all made them -- every live LifeForm
+ * drawn by its own draw(), or for very big populations a density map
+ * (see LifeForm::draw_density), so that a snapshot never costs more than
+ * the pixels it covers.
+ */
+struct Snapshot {
+    SimTime time;
+    Viewport view;              // what the snapshot covers
+    FrameBuffer drawing;        // only the commands; never rasterised
+
+    Snapshot(void) : time(0), view(grid_max, win_x_size, win_y_size),
+                     drawing(win_x_size, win_y_size) {}
+};
+
+/*
+ * Renderer draws the simulation from snapshots, so that the simulation
+ * runs at engine speed rather than at display speed.
+ *
+ * The simulation thread calls publish() (e.g., every time_lapse), which
+ * records the drawing commands into a Snapshot -- O(LifeForms in view),
+ * no pixels and no waiting -- and hands it over through a TripleBuffer.
+ * run() owns the window.  It wakes up 'fps' times a second and draws the
+ * newest snapshot, if there is one it hasn't drawn yet; snapshots
+ * published faster than that are skipped.
+ *
+ * FLTK has to be driven from the main thread (on the Mac, nowhere else
+ * works), so run() is called there, and the simulation gets a thread of
+ * its own; it calls close() when it is done, and run() returns once the
+ * last snapshot is drawn.  Only what is inside the current view goes
+ * into a snapshot; the view can be set here or changed with the keyboard.
+ */
+class Renderer {
+    TripleBuffer<Snapshot> snapshots;
+    std::atomic<bool> done;
+    std::atomic<uint64_t> drawn;
+    double fps;
+    std::mutex view_lock;       // 'view' is shared by both threads
+    Viewport view;
+
+    Renderer(const Renderer&) = delete;
+    void operator=(const Renderer&) = delete;
+public:
+    explicit Renderer(double fps = 30.0);
+
+    void run(void);             // the main thread: draw until closed
+    void publish(void);         // snapshot the current simulation
+    void set_view(const Viewport&); // any thread
+    void close(void);           // no more snapshots; run() returns
+
+    uint64_t num_drawn(void) const { return drawn.load(std::memory_order_relaxed); }
+};
+
+#endif /* !(_Renderer_h) */
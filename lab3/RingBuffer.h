@@ -0,0 +1,55 @@
+#if !(_RingBuffer_h)
+#define _RingBuffer_h 1
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * A fixed size, lock-free, single producer / single consumer queue.
+ *
+ * Exactly one thread may call push and exactly one (other) thread may
+ * call pop.  Neither side ever blocks: push returns false when the
+ * buffer is full and pop returns false when it is empty.
+ *
+ * head is only written by the consumer and tail only by the producer.
+ * Each side publishes its index with a release store after touching the
+ * slot, and reads the other side's index with an acquire load, so a slot
+ * is never read before it has been completely written (and vice versa).
+ *
+ * N must be a power of two so that the indices can simply wrap around.
+ */
+template <typename T, uint32_t N>
+class RingBuffer {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "RingBuffer size must be a power of two");
+
+    T slots[N];
+    std::atomic<uint32_t> head;   // next slot to pop
+    std::atomic<uint32_t> tail;   // next slot to push
+
+    RingBuffer(const RingBuffer&) = delete;
+    void operator=(const RingBuffer&) = delete;
+public:
+    RingBuffer(void) : head(0), tail(0) {}
+
+    bool push(const T& x) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) { return false; }
+        slots[t % N] = x;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& x) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) { return false; }
+        x = slots[h % N];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty(void) const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif /* !(_RingBuffer_h) */
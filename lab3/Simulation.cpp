@@ -0,0 +1,75 @@
+#include "Algae.h"
+#include "Random.h"
+#include "Simulation.h"
+
+using namespace std;
+
+thread_local Simulation* Simulation::cur = nullptr;
+
+double MAX_SIMULATION_TIME = 50000.0;
+
+Simulation::Simulation(unsigned seed, bool with_window)
+    : live_species(0), max_species(0),
+      space(0.0, 0.0, grid_max, grid_max),
+      seed(seed), streams(0), random_generator(seed),
+      win(with_window ? new Canvas(win_x_size, win_y_size) : nullptr),
+#if PARALLEL_DECISIONS
+      decisions(*this),
+#endif /* PARALLEL_DECISIONS */
+      max_time(MAX_SIMULATION_TIME), verbose(true) {}
+
+/*
+ * The LifeForms still in the simulation are only referenced from the
+ * tree and from their pending events.  Drop both while this simulation
+ * is current, so that ~LifeForm removes each one from *our* all_life
+ * (rather than whatever happens to be current when the members go away)
+ */
+Simulation::~Simulation(void) {
+    Scope scope(*this);
+    for (LifeForm* k : all_life) { k->is_alive = false; }
+    events.clear();
+    space.clear();
+}
+
+void Simulation::record_frames(FrameBuffer* fb) {
+    if (!win) {
+        if (!fb) { return; }
+        win.reset(new Canvas(win_x_size, win_y_size, false));
+    }
+    win->record(fb);
+}
+
+/* The Tick class creates an event every 1.00 time units
+* The event is used to add new Algae to the simulation and can
+* also be used to add debugging hooks if you need them
+*/
+class Tick {
+public:
+    static void tock(void) {
+        std::function<void(void)> callme = [](void) { tock(); };
+#if ALGAE_SPORES
+        Algae::create_spontaneously();
+#endif /* ALGAE_SPORES */
+        if (Event::num_events() > 1)
+            (void) new Event(1, callme);
+    }
+};
+
+/* the caller must have made this simulation current */
+void Simulation::start(void) {
+    assert(cur == this);
+    LifeForm::create_life();
+    Tick::tock();
+    broad_phase.start();
+}
+
+bool Simulation::step(void) {
+    assert(cur == this);
+    if (Event::num_events() == 0) { return false; }
+    Event::do_next();
+    return !LifeForm::simulation_complete();
+}
+
+namespace epl {
+    thread_local Xoshiro256* current_generator = nullptr;
+}
@@ -0,0 +1,154 @@
+#if !(_Simulation_h)
+#define _Simulation_h 1
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "BroadPhase.h"
+#include "Decisions.h"
+#include "Event.h"
+#include "LifeForm.h"
+#include "Params.h"
+#include "QuadTree.h"
+#include "Random.h"
+#include "Species.h"
+#include "Window.h"
+
+extern double MAX_SIMULATION_TIME; // the default for Simulation::max_time
+
+/*
+ * Class name: Simulation
+ * Description:
+ *  Everything that used to be a process global -- the space, the list of
+ *  all LifeForms, the per-species totals, the event queue and clock, the
+ *  random number generator and the window -- lives in a Simulation.
+ *
+ *  LifeForm, Event and epl::drand48 always work on the *current*
+ *  simulation of the calling thread.  Use a Simulation::Scope to make a
+ *  simulation current.  Each thread can run its own simulation, as long
+ *  as no LifeForm or Event is ever handed from one simulation to another.
+ *
+ *  The window is optional.  A Simulation without one can't redisplay,
+ *  unless it is recording frames (then it draws on an off-screen Canvas).
+ */
+class Simulation {
+    static thread_local Simulation* cur;
+
+    /* NOTE: declaration order matters -- members are destroyed in reverse
+       order, and the LifeForms destroyed along with 'events' and 'space'
+       remove themselves from all_life */
+    std::vector<LifeForm*> all_life;
+    std::vector<SpeciesStats> species_stats;
+    uint32_t live_species;      // species with at least one live LifeForm
+    uint32_t max_species;       // the most species ever alive at once
+    QuadTree<SmartPointer<LifeForm>> space;
+    EventQueue events;
+    BroadPhase broad_phase;     // its events are in 'events'
+    uint64_t seed;
+    uint64_t streams;           // random streams handed out so far (0 is ours)
+    epl::Xoshiro256 random_generator;
+    std::unique_ptr<Canvas> win;
+#if PARALLEL_DECISIONS
+    Decisions decisions;        // its threads go first
+#endif /* PARALLEL_DECISIONS */
+
+    Simulation(const Simulation&) = delete;
+    void operator=(const Simulation&) = delete;
+    friend class LifeForm;
+public:
+    SimTime max_time;           // stop once the clock passes this
+    bool verbose;               // print a message when the simulation completes
+
+    explicit Simulation(unsigned seed = 0, bool with_window = false);
+    ~Simulation(void);
+
+    static Simulation& current(void) { assert(cur); return *cur; }
+
+    /* make a simulation current on this thread (for the lifetime of the Scope) */
+    class Scope {
+        Simulation* prev_sim;
+        EventQueue* prev_queue;
+        epl::Xoshiro256* prev_generator;
+    public:
+        explicit Scope(Simulation& s)
+            : prev_sim(cur), prev_queue(Event::use_queue(&s.events)),
+              prev_generator(epl::current_generator) {
+            cur = &s;
+            epl::current_generator = &s.random_generator;
+        }
+        ~Scope(void) {
+            cur = prev_sim;
+            Event::use_queue(prev_queue);
+            epl::current_generator = prev_generator;
+        }
+    };
+
+    void start(void);           // create_life and start the algae spores
+    bool step(void);            // do one event, false once the simulation is over
+    void run(void) { while (step()) {} }
+    /* run until the clock reaches t (false if the simulation ended first) */
+    bool run_until(SimTime t) {
+        while (Event::now() < t) { if (!step()) { return false; } }
+        return true;
+    }
+
+    /* join the threads we started (before a fork(), which would not
+       copy them); they are started again when needed */
+    void stop_threads(void) {
+#if PARALLEL_DECISIONS
+        decisions.stop();
+#endif /* PARALLEL_DECISIONS */
+    }
+
+    bool has_window(void) const { return (bool)win; }
+    const BroadPhase& get_broad_phase(void) const { return broad_phase; }
+#if PARALLEL_DECISIONS
+    const Decisions& get_decisions(void) const { return decisions; }
+#endif /* PARALLEL_DECISIONS */
+    double drand48(void) { return random_generator.uniform(); }
+
+    /* also draw into fb (null to stop); makes an off-screen Canvas if
+       we don't have a window */
+    void record_frames(FrameBuffer* fb);
+
+    /* a new, independent generator (e.g., for a LifeForm).  The streams
+       depend only on the seed and the order they are asked for */
+    epl::Xoshiro256 new_stream(void) { return epl::Xoshiro256(seed, ++streams); }
+
+    /* start the random numbers over from a new seed (e.g., a Sweep
+       worker, after it forks).  LifeForms with a stream of their own
+       (PER_LIFEFORM_RNG) keep it */
+    void reseed(uint64_t s) {
+        seed = s;
+        streams = 0;
+        random_generator = epl::Xoshiro256(s);
+    }
+};
+
+/*
+ * LifeForm's static "globals", forwarded to the current simulation.
+ * They are defined here (not in LifeForm.h) because they need the
+ * complete Simulation class.
+ */
+inline QuadTree<SmartPointer<LifeForm>>& LifeForm::space(void) { return Simulation::current().space; }
+inline std::vector<LifeForm*>& LifeForm::all_life(void) { return Simulation::current().all_life; }
+inline BroadPhase& LifeForm::broad_phase(void) { return Simulation::current().broad_phase; }
+inline std::vector<SpeciesStats>& LifeForm::species_stats(void) { return Simulation::current().species_stats; }
+inline uint32_t& LifeForm::live_species(void) { return Simulation::current().live_species; }
+inline uint32_t& LifeForm::max_species(void) { return Simulation::current().max_species; }
+
+inline Canvas& LifeForm::win(void) {
+    assert(Simulation::current().win);
+    return *Simulation::current().win;
+}
+
+inline SpeciesStats& LifeForm::stats(void) const {
+    std::vector<SpeciesStats>& table = species_stats();
+    SpeciesID id = player_id();
+    if (id >= table.size()) { table.resize(id + 1); }
+    return table[id];
+}
+
+#endif /* !(_Simulation_h) */
@@ -1,76 +1,244 @@
-// SmartPointer.h
-#include <cstdint>
-#include <utility>
-#include <type_traits>
-
-class ControlBlock {
-public:
-	uint32_t ref_count = 0;
-};
-
-
-template <typename T>
-class SmartPointer {
-	static_assert(std::is_base_of<ControlBlock, T>::value, "You must use ControlBlock as a base class");
-private:
-
-public:
-	T& operator*(void) const { return *ptr; }
-	T* operator->(void) const { return ptr; }
-
-	SmartPointer(const SmartPointer<T>& rhs) { copy(rhs); }
-
-	SmartPointer<T>& operator=(const SmartPointer<T>& rhs) {
-		if (this != &rhs) {
-			destroy();
-			copy(rhs);
-		}
-		return *this;
-	}
-
-	template <typename U>
-	SmartPointer(const SmartPointer<U>& rhs) {
-		//static_assert(std::is_base_of<T, U>::value, "cannot upcast smart pointers");
-
-		if (rhs.ptr == nullptr) {
-			this->ptr = nullptr;
-			return;
-		}
-
-		ptr = dynamic_cast<T*>(rhs.ptr);
-		ptr->ControlBlock::ref_count += 1;
-	}
-
-	SmartPointer(T* obj = nullptr) {
-		ptr = obj;
-		if (obj) {
-			ptr->ControlBlock::ref_count += 1;
-		}
-	}
-
-	~SmartPointer(void) { destroy(); }
-
-	operator bool(void) const { return ptr; }
-
-private:
-	T* ptr = nullptr;
-	template <typename U>
-	friend class SmartPointer;
-
-	void copy(const SmartPointer<T>& rhs) {
-		this->ptr = rhs.ptr;
-		if (ptr) {
-			ptr->ControlBlock::ref_count += 1;
-		}
-	}
-
-	void destroy(void) {
-		if (ptr) {
-			ptr->ControlBlock::ref_count -= 1;
-			if (ptr->ControlBlock::ref_count == 0) {
-				delete ptr;
-			}
-		}
-	}
-};
-
+// SmartPointer.h
+#if !(_SmartPointer_h)
+#define _SmartPointer_h 1
+
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+#if SMARTPTR_ATOMIC
+#include <atomic>
+#endif /* SMARTPTR_ATOMIC */
+
+class ControlBlock;
+
+/*
+ * The side block for weak references.  It is only allocated when the
+ * first WeakPointer to an object is made, and it outlives the object
+ * for as long as any WeakPointer still refers to it.  'obj' is cleared
+ * as soon as the object's last SmartPointer goes away.
+ */
+struct WeakNode {
+	ControlBlock* obj;
+	uint32_t count;             // WeakPointers, plus one while obj exists
+
+	static void release(WeakNode* node) {
+		node->count -= 1;
+		if (node->count == 0) { delete node; }
+	}
+};
+
+/*
+ * The reference count lives in the object itself (that's the "fused"
+ * allocation -- one new for the object and its count).
+ *
+ * By default the count is a plain integer, which is all a Simulation
+ * needs: its objects never leave the thread that runs it.  Compile with
+ * -DSMARTPTR_ATOMIC=1 if SmartPointers to the same object are copied or
+ * destroyed on several threads at once.
+ *
+ * Copying an object does not copy its count -- the copy is a new object
+ * with no SmartPointers to it (yet).
+ */
+class ControlBlock {
+public:
+#if SMARTPTR_ATOMIC
+	std::atomic<uint32_t> ref_count{ 0 };
+
+	void add_ref(void) { ref_count.fetch_add(1, std::memory_order_relaxed); }
+	/* true iff that was the last reference */
+	bool release(void) { return ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+#else
+	uint32_t ref_count = 0;
+
+	void add_ref(void) { ref_count += 1; }
+	/* true iff that was the last reference */
+	bool release(void) { return --ref_count == 0; }
+#endif /* SMARTPTR_ATOMIC */
+
+	WeakNode* weak = nullptr;
+
+	WeakNode* weak_node(void) {
+		if (!weak) { weak = new WeakNode{ this, 1 }; }
+		return weak;
+	}
+
+	/* tell the WeakPointers that we're gone (before the destructors run,
+	   so that nothing can lock us while we're half destroyed) */
+	void expire(void) {
+		if (weak) {
+			weak->obj = nullptr;
+			WeakNode::release(weak);
+			weak = nullptr;
+		}
+	}
+
+	ControlBlock(void) {}
+	ControlBlock(const ControlBlock&) {}
+	ControlBlock& operator=(const ControlBlock&) { return *this; }
+	~ControlBlock(void) { expire(); }
+};
+
+
+template <typename T>
+class SmartPointer {
+	static_assert(std::is_base_of<ControlBlock, T>::value, "You must use ControlBlock as a base class");
+private:
+
+public:
+	T& operator*(void) const { return *ptr; }
+	T* operator->(void) const { return ptr; }
+	T* get(void) const { return ptr; }
+
+	SmartPointer(const SmartPointer<T>& rhs) { copy(rhs); }
+
+	/* moving steals the reference -- no count changes at all */
+	SmartPointer(SmartPointer<T>&& rhs) : ptr(rhs.ptr) { rhs.ptr = nullptr; }
+
+	SmartPointer<T>& operator=(const SmartPointer<T>& rhs) {
+		if (this != &rhs) {
+			destroy();
+			copy(rhs);
+		}
+		return *this;
+	}
+
+	SmartPointer<T>& operator=(SmartPointer<T>&& rhs) {
+		if (this != &rhs) {
+			destroy();
+			ptr = rhs.ptr;
+			rhs.ptr = nullptr;
+		}
+		return *this;
+	}
+
+	/* conversions: an upcast (U derived from T) is a static_cast;
+	   anything else is checked with dynamic_cast, and gives a null
+	   SmartPointer if the object isn't a T */
+	template <typename U>
+	SmartPointer(const SmartPointer<U>& rhs) {
+		ptr = convert(rhs.ptr, std::is_base_of<T, U>());
+		if (ptr) {
+			ptr->ControlBlock::add_ref();
+		}
+	}
+
+	template <typename U>
+	SmartPointer(SmartPointer<U>&& rhs) {
+		ptr = convert(rhs.ptr, std::is_base_of<T, U>());
+		if (ptr) {
+			rhs.ptr = nullptr;  // the reference moves over to us
+		}
+	}
+
+	SmartPointer(T* obj = nullptr) {
+		ptr = obj;
+		if (obj) {
+			ptr->ControlBlock::add_ref();
+		}
+	}
+
+	~SmartPointer(void) { destroy(); }
+
+	operator bool(void) const { return ptr; }
+
+private:
+	T* ptr = nullptr;
+	template <typename U>
+	friend class SmartPointer;
+
+	template <typename U>
+	static T* convert(U* p, std::true_type) { return p; }
+	template <typename U>
+	static T* convert(U* p, std::false_type) { return dynamic_cast<T*>(p); }
+
+	void copy(const SmartPointer<T>& rhs) {
+		this->ptr = rhs.ptr;
+		if (ptr) {
+			ptr->ControlBlock::add_ref();
+		}
+	}
+
+	void destroy(void) {
+		if (ptr) {
+			if (ptr->ControlBlock::release()) {
+				ptr->ControlBlock::expire();
+				delete ptr;
+			}
+		}
+	}
+};
+
+/*
+ * A WeakPointer refers to an object without keeping it alive.  lock()
+ * returns a SmartPointer to the object, or a null one if the object has
+ * already been deleted.
+ *
+ * Scheduled callbacks should hold WeakPointers: then an object goes away
+ * as soon as the simulation drops it (e.g., when it dies and leaves the
+ * QuadTree) instead of when its last pending event has fired.
+ *
+ * NOTE: even with SMARTPTR_ATOMIC, lock() is only safe on the thread that
+ * owns the object's strong references.
+ */
+template <typename T>
+class WeakPointer {
+	static_assert(std::is_base_of<ControlBlock, T>::value, "You must use ControlBlock as a base class");
+
+	WeakNode* node = nullptr;
+	T* ptr = nullptr;           // valid only while node->obj is set
+
+	void copy(const WeakPointer<T>& rhs) {
+		node = rhs.node;
+		ptr = rhs.ptr;
+		if (node) { node->count += 1; }
+	}
+
+	void destroy(void) {
+		if (node) { WeakNode::release(node); }
+	}
+public:
+	WeakPointer(void) {}
+
+	WeakPointer(T* obj) : ptr(obj) {
+		if (obj) {
+			node = obj->ControlBlock::weak_node();
+			node->count += 1;
+		}
+	}
+
+	WeakPointer(const SmartPointer<T>& p) : WeakPointer(p.get()) {}
+
+	WeakPointer(const WeakPointer<T>& rhs) { copy(rhs); }
+	WeakPointer(WeakPointer<T>&& rhs) : node(rhs.node), ptr(rhs.ptr) { rhs.node = nullptr; }
+
+	WeakPointer<T>& operator=(const WeakPointer<T>& rhs) {
+		if (this != &rhs) {
+			destroy();
+			copy(rhs);
+		}
+		return *this;
+	}
+
+	WeakPointer<T>& operator=(WeakPointer<T>&& rhs) {
+		if (this != &rhs) {
+			destroy();
+			node = rhs.node;
+			ptr = rhs.ptr;
+			rhs.node = nullptr;
+		}
+		return *this;
+	}
+
+	~WeakPointer(void) { destroy(); }
+
+	bool expired(void) const { return !node || !node->obj; }
+	SmartPointer<T> lock(void) const { return expired() ? SmartPointer<T>() : SmartPointer<T>(ptr); }
+};
+
+/* make_smart<T>(args...) is SmartPointer<T>(new T(args...)) */
+template <typename T, typename... Args>
+SmartPointer<T> make_smart(Args&&... args) {
+	return SmartPointer<T>(new T(std::forward<Args>(args)...));
+}
+
+#endif /* !(_SmartPointer_h) */
@@ -0,0 +1,99 @@
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Species.h"
+
+using namespace std;
+
+/*
+ * Same trick as LifeForm::istream_creators -- the tables are static
+ * locals so that they exist before the first intern, no matter which
+ * global constructor gets there first.
+ *
+ * The names are kept in blocks that are never moved or freed, and an
+ * entry is never changed once its ID has been handed out, so name()
+ * reads without the lock: whoever has an ID got it (one way or another)
+ * from an intern that had already put the name in place.  The lock is
+ * only taken by intern, for a name this thread has not looked up before.
+ */
+namespace {
+    const unsigned block_bits = 8;
+    const SpeciesID block_size = 1 << block_bits;
+    const SpeciesID max_blocks = 4096;
+
+    struct Names {
+        atomic<string*> blocks[max_blocks];
+        atomic<SpeciesID> count;
+
+        Names(void) : count(0) {
+            for (auto& b : blocks) { b.store(nullptr, memory_order_relaxed); }
+            add(string());
+        }
+
+        /* the caller holds table_lock */
+        SpeciesID add(const string& s) {
+            SpeciesID id = count.load(memory_order_relaxed);
+            assert(id < max_blocks * block_size);
+            string* block = blocks[id >> block_bits].load(memory_order_relaxed);
+            if (!block) {
+                block = new string[block_size];
+                blocks[id >> block_bits].store(block, memory_order_release);
+            }
+            block[id & (block_size - 1)] = s;
+            count.store(id + 1, memory_order_release);
+            return id;
+        }
+
+        const string& operator[](SpeciesID id) const {
+            return blocks[id >> block_bits].load(memory_order_acquire)[id & (block_size - 1)];
+        }
+    };
+
+    mutex& table_lock(void) {
+        static mutex the_lock;
+        return the_lock;
+    }
+
+    Names& names(void) {
+        static Names the_names;
+        return the_names;
+    }
+
+    unordered_map<string, SpeciesID>& ids(void) {
+        static unordered_map<string, SpeciesID> the_ids{ { string(), 0 } };
+        return the_ids;
+    }
+}
+
+SpeciesID SpeciesTable::intern(const string& s) {
+    /* IDs never change, so each thread remembers the ones it has seen */
+    static thread_local unordered_map<string, SpeciesID> seen;
+    auto q = seen.find(s);
+    if (q != seen.end()) { return q->second; }
+
+    SpeciesID id;
+    {
+        lock_guard<mutex> guard(table_lock());
+        auto p = ids().find(s);
+        if (p != ids().end()) {
+            id = p->second;
+        } else {
+            id = names().add(s);
+            ids()[s] = id;
+        }
+    }
+    seen[s] = id;
+    return id;
+}
+
+const string& SpeciesTable::name(SpeciesID id) {
+    assert(id < names().count.load(memory_order_acquire));
+    return names()[id];
+}
+
+SpeciesID SpeciesTable::size(void) {
+    return names().count.load(memory_order_acquire);
+}
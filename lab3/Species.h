@@ -0,0 +1,82 @@
+#if !(_Species_h)
+#define _Species_h 1
+
+#include <cstdint>
+#include <string>
+
+/*
+ * Species names are interned into a single global symbol table.
+ * Every distinct name gets a small integer SpeciesID, so the simulator
+ * can compare, hash and index species without copying strings around.
+ * ID 0 is always the empty name.
+ *
+ * The table only grows.  Names are never removed or moved, so an ID
+ * (and the reference returned by SpeciesTable::name) stays valid for the
+ * rest of the program, and name() can be called from any thread without
+ * taking a lock.
+ */
+typedef uint32_t SpeciesID;
+
+class SpeciesTable {
+public:
+    static const SpeciesID invalid = 0xffffffff; // "not yet looked up"
+
+    static SpeciesID intern(const std::string&); // find or add a name
+    static const std::string& name(SpeciesID);   // the name for an ID
+    static SpeciesID size(void);                 // number of IDs handed out
+};
+
+/*
+ * SpeciesName is what ObjInfo carries around.  It is just a SpeciesID,
+ * but it converts to (and compares against) std::string so that species
+ * written against the old string interface keep working.  The string is
+ * looked up only when somebody actually asks for it.
+ */
+class SpeciesName {
+    SpeciesID _id;
+public:
+    SpeciesName(void) : _id(0) {}
+    explicit SpeciesName(SpeciesID id) : _id(id) {}
+    SpeciesName(const std::string& s) : _id(SpeciesTable::intern(s)) {}
+    SpeciesName(const char* s) : _id(SpeciesTable::intern(s)) {}
+
+    SpeciesID id(void) const { return _id; }
+    const std::string& str(void) const { return SpeciesTable::name(_id); }
+    operator const std::string&(void) const { return str(); }
+
+    bool operator==(const SpeciesName& o) const { return _id == o._id; }
+    bool operator!=(const SpeciesName& o) const { return _id != o._id; }
+    bool operator==(const std::string& s) const { return str() == s; }
+    bool operator!=(const std::string& s) const { return str() != s; }
+    bool operator==(const char* s) const { return str() == s; }
+    bool operator!=(const char* s) const { return str() != s; }
+};
+
+/*
+ * Running totals for one species (keyed by player ID).  LifeForm keeps
+ * these up to date as energy changes, so summaries never have to walk
+ * every LifeForm.
+ */
+struct SpeciesStats {
+    uint32_t alive = 0;         // LifeForms currently in the simulation
+    double energy = 0.0;        // total energy of the live ones
+    uint64_t births = 0;        // created by create_life, reproduce or spores
+    uint64_t deaths = 0;
+    uint64_t eats = 0;          // successful meals
+    double extinct_at = 0.0;    // sim time at which alive last dropped to 0
+
+    /* the live ones' aging and income ticks that nobody has settled yet
+       (see LifeForm::settle_energy) come to about rate * now - rate_base:
+       each LifeForm adds its energy per unit time to rate, times its
+       energy_time to rate_base */
+    double rate = 0.0;
+    double rate_base = 0.0;
+    double unsettled(double now) const { return rate * now - rate_base; }
+};
+
+inline bool operator==(const std::string& s, const SpeciesName& n) { return n == s; }
+inline bool operator!=(const std::string& s, const SpeciesName& n) { return n != s; }
+inline bool operator==(const char* s, const SpeciesName& n) { return n == s; }
+inline bool operator!=(const char* s, const SpeciesName& n) { return n != s; }
+
+#endif /* !(_Species_h) */
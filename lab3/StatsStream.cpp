@@ -0,0 +1,106 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "Event.h"
+#include "LifeForm.h"
+#include "MemoryAccount.h"
+#include "StatsStream.h"
+
+using namespace std;
+
+StatsStream::StatsStream(const string& file_name, SimTime interval)
+    : out(file_name), done(false), interval(interval),
+      next_sample(Event::now()), dropped(0) {
+    if (!out) {
+        cerr << "StatsStream: cannot open " << file_name << "\n";
+    }
+    out << "time,kind,species,count,energy,a,b,c\n";
+    writer = thread([this](void) { drain(); });
+}
+
+void StatsStream::push(const StatsRecord& r) {
+    if (!buffer.push(r)) { dropped += 1; }
+}
+
+/*
+ * runs on the simulation thread -- no I/O, no locks.  O(species)
+ */
+void StatsStream::sample(void) {
+    StatsRecord r;
+    r.time = Event::now();
+    r.kind = StatsRecord::WORLD;
+    r.species = 0;
+    r.count = LifeForm::population();
+    r.energy = 0.0;
+    r.a = Event::num_dispatched();
+    r.b = Event::num_events();
+    r.c = LifeForm::num_life_forms();
+    push(r);
+
+    const vector<SpeciesStats>& totals = LifeForm::species_totals();
+    r.kind = StatsRecord::SPECIES;
+    for (SpeciesID id = 0; id < totals.size(); ++id) {
+        const SpeciesStats& s = totals[id];
+        if (s.births == 0) { continue; } // never been in the simulation
+        r.species = id;
+        r.count = s.alive;
+        r.energy = s.energy;
+        r.a = s.births;
+        r.b = s.deaths;
+        r.c = s.eats;
+        push(r);
+    }
+
+#if MEMORY_ACCOUNTING
+    r.kind = StatsRecord::MEMORY;
+    r.energy = 0.0;
+    for (unsigned k = 0; k < memory::num_accounts(); ++k) {
+        const MemoryAccount& m = memory::account(k);
+        if (m.allocations == 0) { continue; }
+        r.species = k;
+        r.count = m.count;
+        r.a = m.bytes;
+        r.b = m.peak_bytes;
+        r.c = m.peak_count;
+        push(r);
+    }
+#endif /* MEMORY_ACCOUNTING */
+
+    next_sample = Event::now() + interval;
+}
+
+void StatsStream::write(const StatsRecord& r) {
+    out << r.time << ',';
+    if (r.kind == StatsRecord::WORLD) {
+        out << "world,";
+#if MEMORY_ACCOUNTING
+    } else if (r.kind == StatsRecord::MEMORY) {
+        out << "memory," << memory::account_name(r.species);
+#endif /* MEMORY_ACCOUNTING */
+    } else {
+        out << "species," << SpeciesTable::name(r.species);
+    }
+    out << ',' << r.count << ',' << r.energy
+        << ',' << r.a << ',' << r.b << ',' << r.c << '\n';
+}
+
+void StatsStream::drain(void) {
+    StatsRecord r;
+    for (;;) {
+        bool finished = done.load(memory_order_acquire);
+        while (buffer.pop(r)) { write(r); }
+        if (finished) { break; }
+        this_thread::sleep_for(chrono::milliseconds{ 5 });
+    }
+    out.flush();
+}
+
+void StatsStream::close(void) {
+    if (!writer.joinable()) { return; }
+    done.store(true, memory_order_release);
+    writer.join();
+    if (dropped > 0) {
+        cerr << "StatsStream: " << dropped << " records dropped\n";
+    }
+}
@@ -0,0 +1,75 @@
+#if !(_StatsStream_h)
+#define _StatsStream_h 1
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "Event.h"
+#include "RingBuffer.h"
+#include "Species.h"
+
+/*
+ * One sample in the stats stream.  A WORLD record describes the whole
+ * simulation, a SPECIES record describes one player.  The meaning of
+ * the generic fields depends on the kind:
+ *
+ *              count          a                b               c
+ *   WORLD      tree size      events done      events pending  all_life size
+ *   SPECIES    alive          births           deaths          eats
+ *   MEMORY     live objects   bytes            peak bytes      peak objects
+ *
+ * (MEMORY records only with MEMORY_ACCOUNTING; 'species' is then the
+ * number of a memory account, see MemoryAccount.h)
+ */
+struct StatsRecord {
+    enum Kind : uint32_t { WORLD, SPECIES, MEMORY };
+
+    SimTime time;
+    Kind kind;
+    SpeciesID species;          // SPECIES only
+    uint64_t count;
+    double energy;              // SPECIES only
+    uint64_t a, b, c;
+};
+
+/*
+ * StatsStream records a time series of the simulation for headless runs.
+ *
+ * The simulation thread calls poll() after every event.  Nothing happens
+ * until 'interval' sim-time units have passed since the last sample.
+ * Then it copies the per-species totals (which LifeForm keeps current)
+ * into a lock-free ring buffer, one record per species.  It never does
+ * any I/O and never waits.  A background thread drains the buffer into
+ * a CSV file.  If the writer falls behind, records are dropped and
+ * counted rather than stalling the simulation.
+ */
+class StatsStream {
+    RingBuffer<StatsRecord, 4096> buffer;
+    std::ofstream out;
+    std::thread writer;
+    std::atomic<bool> done;
+    SimTime interval;
+    SimTime next_sample;
+    uint64_t dropped;
+
+    void push(const StatsRecord&);
+    void drain(void);           // body of the writer thread
+    void write(const StatsRecord&);
+
+    StatsStream(const StatsStream&) = delete;
+    void operator=(const StatsStream&) = delete;
+public:
+    StatsStream(const std::string& file_name, SimTime interval);
+    ~StatsStream(void) { close(); }
+
+    void poll(void) { if (Event::now() >= next_sample) { sample(); } }
+    void sample(void);          // take a sample now
+    void close(void);           // flush everything and stop the writer
+
+    uint64_t num_dropped(void) const { return dropped; }
+};
+
+#endif /* !(_StatsStream_h) */
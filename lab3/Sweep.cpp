@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#if !defined (_MSC_VER)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "LifeForm.h"
+#include "Params.h"
+#include "Simulation.h"
+#include "Sweep.h"
+
+using namespace std;
+
+Sweep::Sweep(SimTime fork_time, SimTime max_time, unsigned jobs)
+    : fork_time(fork_time), max_time(max_time), jobs(jobs) {
+    if (jobs == 0) { this->jobs = max(1u, thread::hardware_concurrency()); }
+}
+
+bool Sweep::read(std::istream& in) {
+    string line;
+    while (getline(in, line)) {
+        istringstream words(line);
+        string word;
+        Run r;
+        r.seed = runs.size() + 1;
+        while (words >> word) {
+            if (word[0] == '#') { break; }
+            size_t eq = word.find('=');
+            if (eq == string::npos || eq == 0) {
+                cerr << "Sweep: expected name=value, not " << word << "\n";
+                return false;
+            }
+            string name = word.substr(0, eq), value = word.substr(eq + 1);
+            if (name == "seed") { r.seed = atoi(value.c_str()); }
+            else { r.params.push_back(make_pair(name, value)); }
+            if (!r.settings.empty()) { r.settings += " "; }
+            r.settings += word;
+        }
+        if (!r.settings.empty()) { runs.push_back(r); }
+    }
+    return true;
+}
+
+#if defined (_MSC_VER)
+
+void Sweep::worker(Run&, int) {}
+void Sweep::collect(Run&, int, int) {}
+
+void Sweep::run(void) {
+    cerr << "Sweep: needs fork(), which this system doesn't have\n";
+}
+
+#else
+
+/*
+ * The child: one line per species,
+ *      name alive births deaths energy extinct_at
+ * in the order of the ranking, or one "error ..." line
+ */
+void Sweep::worker(Run& r, int fd) {
+    ostringstream out;
+    out << setprecision(17);
+    for (const auto& p : r.params) {
+        if (!set_param(p.first, p.second)) {
+            out << "error bad parameter " << p.first << "=" << p.second << "\n";
+            break;
+        }
+    }
+    if (out.str().empty()) {
+        Simulation& sim = Simulation::current();
+        sim.reseed(r.seed);
+        sim.max_time = max_time;
+        sim.verbose = false;
+        sim.run();
+
+        using Entry = pair<SpeciesID, SpeciesStats>;
+        vector<Entry> ranking;
+        const vector<SpeciesStats>& totals = LifeForm::species_totals();
+        for (SpeciesID id = 0; id < totals.size(); ++id) {
+            if (totals[id].births > 0) { ranking.push_back(Entry(id, totals[id])); }
+        }
+        sort(ranking.begin(), ranking.end(), [](const Entry& a, const Entry& b) {
+            bool a_alive = a.second.alive > 0;
+            bool b_alive = b.second.alive > 0;
+            if (a_alive != b_alive) { return a_alive; }
+            if (a_alive) { return a.second.energy > b.second.energy; }
+            return a.second.extinct_at > b.second.extinct_at;
+        });
+        for (const Entry& e : ranking) {
+            out << SpeciesTable::name(e.first) << " " << e.second.alive << " "
+                << e.second.births << " " << e.second.deaths << " "
+                << e.second.energy << " " << e.second.extinct_at << "\n";
+        }
+    }
+
+    string s = out.str();
+    for (size_t done = 0; done < s.size(); ) {
+        ssize_t n = write(fd, s.data() + done, s.size() - done);
+        if (n <= 0) { break; }
+        done += n;
+    }
+    /* no destructors -- the parent's copy of the world is still in use,
+       and tearing down ours would only touch (and copy) its pages */
+    _exit(0);
+}
+
+void Sweep::collect(Run& r, int pid, int fd) {
+    string text;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0) { text.append(buf, n); }
+    close(fd);
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        r.error = "the run crashed";
+        return;
+    }
+
+    istringstream lines(text);
+    string line;
+    while (getline(lines, line)) {
+        if (line.compare(0, 6, "error ") == 0) {
+            r.error = line.substr(6);
+            return;
+        }
+        istringstream words(line);
+        Result result;
+        words >> result.species >> result.alive >> result.births >> result.deaths
+              >> result.energy >> result.extinct_at;
+        if (words) { r.results.push_back(result); }
+    }
+}
+
+void Sweep::run(void) {
+    Simulation sim(0);
+    Simulation::Scope scope(sim);
+    sim.verbose = false;
+    sim.start();
+    if (!sim.run_until(fork_time)) {
+        cerr << "Sweep: the simulation ended before time " << fork_time << "\n";
+    }
+
+    /* the children inherit our buffers -- empty them first, or the
+       output would be written once per child */
+    cout.flush();
+    cerr.flush();
+    sim.stop_threads();
+
+    struct Job { size_t run; int pid; int fd; };
+    deque<Job> running;
+    for (size_t k = 0; k < runs.size(); ++k) {
+        if (running.size() == jobs) {
+            collect(runs[running.front().run], running.front().pid, running.front().fd);
+            running.pop_front();
+        }
+        int fds[2];
+        if (pipe(fds) != 0) {
+            runs[k].error = "no pipe";
+            continue;
+        }
+        int pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            for (const Job& j : running) { close(j.fd); }
+            worker(runs[k], fds[1]);
+        }
+        close(fds[1]);
+        if (pid < 0) {
+            close(fds[0]);
+            runs[k].error = "fork failed";
+            continue;
+        }
+        running.push_back(Job{ k, pid, fds[0] });
+    }
+    /* oldest first -- a child that fills its pipe just waits for us */
+    for (const Job& j : running) { collect(runs[j.run], j.pid, j.fd); }
+}
+
+#endif /* _MSC_VER */
+
+void Sweep::report(ostream& out) const {
+    out << runs.size() << " runs forked at time " << fork_time
+        << ", max time " << max_time << ", " << jobs << " at once\n";
+    out << "    " << left << setw(24) << "species" << right
+        << setw(8) << "alive" << setw(10) << "births" << setw(10) << "deaths"
+        << setw(14) << "energy" << setw(12) << "extinct" << "\n";
+    for (size_t k = 0; k < runs.size(); ++k) {
+        const Run& r = runs[k];
+        out << "run " << k + 1 << ": " << r.settings;
+        if (r.settings.find("seed=") == string::npos) { out << " (seed " << r.seed << ")"; }
+        out << "\n";
+        if (!r.error.empty()) {
+            out << "    " << r.error << "\n";
+            continue;
+        }
+        out << fixed << setprecision(2);
+        for (const Result& s : r.results) {
+            out << "    " << left << setw(24) << s.species << right
+                << setw(8) << s.alive << setw(10) << s.births << setw(10) << s.deaths
+                << setw(14) << s.energy
+                << setw(12) << (s.alive ? string("") : to_string((long) s.extinct_at)) << "\n";
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#if !(_Sweep_h)
+#define _Sweep_h 1
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SimTime.h"
+
+/*
+ * Class name: Sweep
+ * Description:
+ *  Runs the config with many parameter sets.  The world is built (and
+ *  run up to fork_time) only once.  Then every run is a fork()ed copy of
+ *  the process, which shares the parent's pages until it writes to them
+ *  (copy on write), so starting a run costs next to nothing.  A run sets
+ *  its parameters (see set_param) and seed, runs to max_time and sends
+ *  its species totals back to the parent over a pipe.  At most 'jobs'
+ *  runs are alive at once.
+ *
+ *  A sweep file has one run per line, name=value settings separated by
+ *  spaces, e.g.
+ *      seed=7 encounter_strategy=EVEN_MONEY eat_efficiency=0.8
+ *  'seed' is the run's seed (the default is the run's number); the rest
+ *  are parameters.  Blank lines and lines starting with # are skipped.
+ *  The parameters only change from fork_time on -- e.g., start_energy is
+ *  for the LifeForms born after that.
+ *
+ *  POSIX only (fork and pipes).
+ */
+class Sweep {
+    struct Result {
+        std::string species;
+        unsigned alive, births, deaths;
+        double energy;
+        SimTime extinct_at;
+    };
+
+    struct Run {
+        std::string settings;       // the line from the sweep file
+        std::vector<std::pair<std::string, std::string>> params;
+        unsigned seed;
+        std::string error;          // why it has no results
+        std::vector<Result> results; // ranked like a Tournament's
+    };
+
+    SimTime fork_time;
+    SimTime max_time;
+    unsigned jobs;
+    std::vector<Run> runs;
+
+    void worker(Run&, int fd);      // in the child; never returns
+    void collect(Run&, int pid, int fd); // in the parent, once the child is done
+public:
+    Sweep(SimTime fork_time, SimTime max_time, unsigned jobs);
+
+    bool read(std::istream&);       // add the runs (false on a bad line)
+    void run(void);
+    void report(std::ostream&) const;
+};
+
+#endif /* !(_Sweep_h) */
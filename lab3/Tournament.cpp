@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <thread>
+
+#include "LifeForm.h"
+#include "Simulation.h"
+#include "Tournament.h"
+
+using namespace std;
+
+Tournament::Tournament(unsigned runs, unsigned threads, SimTime max_time, unsigned first_seed)
+    : num_runs(runs), num_threads(threads), max_time(max_time),
+      first_seed(first_seed), runs_done(0) {
+    if (num_threads == 0) { num_threads = 1; }
+    if (num_threads > num_runs) { num_threads = num_runs; }
+}
+
+/*
+ * worker k does runs k, k + num_threads, k + 2 * num_threads, ...
+ * the runs are about the same length, so a static split is good enough
+ */
+void Tournament::worker(unsigned first_run) {
+    for (unsigned k = first_run; k < num_runs; k += num_threads) {
+        run_one(first_seed + k);
+    }
+}
+
+void Tournament::run_one(unsigned seed) {
+    using Entry = pair<SpeciesID, SpeciesStats>;
+    vector<Entry> ranking;
+
+    {
+        Simulation sim(seed);
+        Simulation::Scope scope(sim);
+        sim.max_time = max_time;
+        sim.verbose = false;
+        sim.start();
+        sim.run();
+
+        const vector<SpeciesStats>& totals = LifeForm::species_totals();
+        for (SpeciesID id = 0; id < totals.size(); ++id) {
+            if (totals[id].births > 0) { ranking.push_back(Entry(id, totals[id])); }
+        }
+    }
+
+    sort(ranking.begin(), ranking.end(), [](const Entry& a, const Entry& b) {
+        bool a_alive = a.second.alive > 0;
+        bool b_alive = b.second.alive > 0;
+        if (a_alive != b_alive) { return a_alive; }
+        if (a_alive) { return a.second.energy > b.second.energy; }
+        return a.second.extinct_at > b.second.extinct_at;
+    });
+
+    lock_guard<mutex> guard(results_lock);
+    for (unsigned k = 0; k < ranking.size(); ++k) {
+        const SpeciesStats& s = ranking[k].second;
+        Totals& t = results[ranking[k].first];
+        t.runs += 1;
+        t.rank += k + 1;
+        if (k == 0) { t.wins += 1; }
+        if (s.alive > 0) {
+            t.survived += 1;
+            t.energy += s.energy;
+        } else {
+            t.extinct_at += s.extinct_at;
+        }
+    }
+    runs_done += 1;
+}
+
+void Tournament::run(void) {
+    vector<thread> pool;
+    for (unsigned k = 0; k < num_threads; ++k) {
+        pool.push_back(thread([this, k](void) { worker(k); }));
+    }
+    for (thread& t : pool) { t.join(); }
+}
+
+void Tournament::report(ostream& out) const {
+    using Entry = pair<SpeciesID, Totals>;
+    vector<Entry> table(results.begin(), results.end());
+    sort(table.begin(), table.end(), [](const Entry& a, const Entry& b) {
+        return a.second.rank / a.second.runs < b.second.rank / b.second.runs;
+    });
+
+    out << runs_done << " runs, " << num_threads << " threads, max time " << max_time << "\n";
+    out << left << setw(24) << "species" << right
+        << setw(8) << "runs" << setw(8) << "wins" << setw(10) << "survived"
+        << setw(10) << "mean rank" << setw(14) << "mean energy" << setw(14) << "mean extinct" << "\n";
+    out << fixed << setprecision(2);
+    for (const Entry& e : table) {
+        const Totals& t = e.second;
+        out << left << setw(24) << SpeciesTable::name(e.first) << right
+            << setw(8) << t.runs << setw(8) << t.wins << setw(10) << t.survived
+            << setw(10) << t.rank / t.runs
+            << setw(14) << (t.survived ? t.energy / t.survived : 0.0)
+            << setw(14) << (t.runs > t.survived ? t.extinct_at / (t.runs - t.survived) : 0.0)
+            << "\n";
+    }
+}
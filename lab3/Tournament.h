@@ -0,0 +1,53 @@
+#if !(_Tournament_h)
+#define _Tournament_h 1
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "SimTime.h"
+#include "Species.h"
+
+/*
+ * Class name: Tournament
+ * Description:
+ *  Runs the same config many times with different seeds and ranks the
+ *  species over all of the runs.
+ *
+ *  Each run is a complete, independent Simulation (no window, no output)
+ *  and the runs are spread over a pool of worker threads.  At the end of
+ *  a run the species are ranked: the survivors first, by total energy,
+ *  then the extinct species, the last to die out first.  The table from
+ *  report() is sorted by mean rank.
+ */
+class Tournament {
+    struct Totals {
+        unsigned runs = 0;          // runs the species took part in
+        unsigned survived = 0;      // runs in which it was still alive at the end
+        unsigned wins = 0;          // runs in which it ranked first
+        double rank = 0.0;          // sum of the ranks
+        double energy = 0.0;        // sum of the final total energies
+        double extinct_at = 0.0;    // sum of the extinction times (extinct runs only)
+    };
+
+    unsigned num_runs;
+    unsigned num_threads;
+    SimTime max_time;
+    unsigned first_seed;
+
+    std::mutex results_lock;
+    std::map<SpeciesID, Totals> results;
+    unsigned runs_done;
+
+    void worker(unsigned first_run);
+    void run_one(unsigned seed);
+public:
+    Tournament(unsigned runs, unsigned threads, SimTime max_time, unsigned first_seed = 1);
+
+    void run(void);
+    void report(std::ostream&) const;
+};
+
+#endif /* !(_Tournament_h) */
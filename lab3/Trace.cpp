@@ -0,0 +1,203 @@
+#include "Trace.h"
+
+#if TRACE_EVENTS
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#if defined (_MSC_VER)
+#include <fstream>
+#include <vector>
+#else
+#include <cxxabi.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "Species.h"
+
+using namespace std;
+
+namespace Trace {
+
+/*
+ * One trace file.  On POSIX systems the whole file is mapped (MAP_SHARED),
+ * so the records are in the page cache as soon as they are written.
+ * Elsewhere we keep the file in memory and write it out on close
+ */
+class Recorder {
+    Header* header;
+    Record* ring;
+    size_t file_size;
+#if defined (_MSC_VER)
+    vector<char> memory;
+    string file_name;
+#else
+    void* mapping;
+#endif
+    unordered_map<const type_info*, uint16_t> kinds;
+
+    /* the last few handler types looked up (most events are one of a
+       handful of kinds) */
+    static const unsigned cache_size = 64;
+    struct { const type_info* type; uint16_t kind; } cache[cache_size];
+
+    /* for measuring how fast ticks() goes */
+    uint64_t start_ticks;
+    chrono::steady_clock::time_point start_time;
+
+    double ticks_per_second(void) const {
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+        return seconds > 0.0 ? (ticks() - start_ticks) / seconds : 0.0;
+    }
+
+    Recorder(const Recorder&) = delete;
+    void operator=(const Recorder&) = delete;
+
+    void add_kind(const char* name) {
+        uint16_t k = header->num_kinds++;
+        strncpy(header->kinds[k], name, kind_name_size - 1);
+    }
+public:
+    Recorder(void) : header(nullptr), ring(nullptr), file_size(0) {
+        memset(cache, 0, sizeof(cache));
+    }
+    ~Recorder(void) { unmap(); }
+
+    bool map(const string& name, uint64_t capacity) {
+        /* the ring starts on a page boundary after the header */
+        size_t offset = (sizeof(Header) + 4095) & ~(size_t) 4095;
+        file_size = offset + capacity * sizeof(Record);
+#if defined (_MSC_VER)
+        file_name = name;
+        memory.assign(file_size, 0);
+        header = (Header*) memory.data();
+#else
+        int fd = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) { return false; }
+        if (ftruncate(fd, file_size) != 0) { ::close(fd); return false; }
+        mapping = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) { return false; }
+        header = (Header*) mapping;
+#endif
+        memcpy(header->magic, magic, sizeof(magic));
+        header->version = version;
+        header->record_size = sizeof(Record);
+        header->capacity = capacity;
+        header->records_offset = offset;
+        header->written = 0;
+        header->num_kinds = 0;
+        header->num_species = 0;
+        ring = (Record*) ((char*) header + offset);
+        add_kind("QuadTree resize");    // RESIZE
+
+        /* a first guess at the clock rate (close measures it over the
+           whole trace) */
+        start_time = chrono::steady_clock::now();
+        start_ticks = ticks();
+        while (chrono::steady_clock::now() - start_time < chrono::milliseconds(10)) {}
+        header->ticks_per_second = ticks_per_second();
+        return true;
+    }
+
+    void unmap(void) {
+        if (!header) { return; }
+        header->ticks_per_second = ticks_per_second();
+#if defined (_MSC_VER)
+        ofstream out(file_name, ios::binary);
+        out.write(memory.data(), min(memory.size(), (size_t) header->records_offset
+                                     + min(header->written, header->capacity) * sizeof(Record)));
+        memory.clear();
+#else
+        munmap(mapping, file_size);
+#endif
+        header = nullptr;
+    }
+
+    uint16_t kind(const type_info& t) {
+        auto& c = cache[((uintptr_t) &t >> 4) % cache_size];
+        if (c.type == &t) { return c.kind; }
+        auto k = kinds.find(&t);
+        if (k != kinds.end()) {
+            c.type = &t;
+            c.kind = k->second;
+            return k->second;
+        }
+        uint16_t index = max_kinds - 1;     // "other"
+        if (header->num_kinds < max_kinds - 1) {
+            index = header->num_kinds;
+#if defined (_MSC_VER)
+            add_kind(t.name());
+#else
+            int status;
+            char* name = abi::__cxa_demangle(t.name(), nullptr, nullptr, &status);
+            add_kind(status == 0 ? name : t.name());
+            free(name);
+#endif
+        } else if (header->num_kinds == max_kinds - 1) {
+            add_kind("other");
+        }
+        kinds[&t] = index;
+        return index;
+    }
+
+    uint64_t start(void) const { return start_ticks; }
+
+    void put(const Record& r, uint32_t species) {
+        if (species != NO_SPECIES && species >= header->num_species) {
+            /* name every species up to this one */
+            SpeciesID n = min((SpeciesID) max_species, SpeciesTable::size());
+            for (SpeciesID s = header->num_species; s < n; ++s) {
+                strncpy(header->species[s], SpeciesTable::name(s).c_str(), species_name_size - 1);
+            }
+            header->num_species = max(header->num_species, (uint32_t) n);
+        }
+        ring[header->written % header->capacity] = r;
+        header->written += 1;
+    }
+};
+
+thread_local Recorder* current = nullptr;
+static thread_local uint64_t objects = 0;
+
+bool open(const string& file_name, uint64_t capacity) {
+    close();
+    Recorder* r = new Recorder;
+    if (capacity == 0 || !r->map(file_name, capacity)) {
+        cerr << "Trace::open: can't make " << file_name << "\n";
+        delete r;
+        return false;
+    }
+    current = r;
+    return true;
+}
+
+void close(void) {
+    delete current;
+    current = nullptr;
+}
+
+uint64_t new_object(void) { return ++objects; }
+
+uint16_t kind(const type_info& t) { return current->kind(t); }
+
+void record(uint16_t kind, double sim_time, uint64_t object, uint32_t species,
+            uint64_t start) {
+    uint64_t end = ticks();
+    Record r;
+    r.sim_time = sim_time;
+    r.wall = start - current->start();
+    r.object = object;
+    r.duration = (uint32_t) min<uint64_t>(0xffffffff, end - start);
+    r.kind = kind;
+    r.species = species < max_species ? species : NO_SPECIES;
+    current->put(r, r.species);
+}
+
+}
+
+#endif /* TRACE_EVENTS */
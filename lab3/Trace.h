@@ -0,0 +1,133 @@
+#if !(_Trace_h)
+#define _Trace_h 1
+
+#include <cstdint>
+
+/*
+ * Event tracing (compile with -DTRACE_EVENTS=1).
+ *
+ * Once Trace::open has been called on a thread, Event::do_next writes one
+ * Record for every event it dispatches on that thread, and
+ * LifeForm::region_resize one for every QuadTree resize callback: the sim
+ * time, the wall clock time, the kind of handler, the owner's object ID
+ * and species and how long the handler took.
+ *
+ * The records go into a ring of 'capacity' Records in a memory-mapped
+ * file, so recording one is two clock reads and a 32-byte store -- no
+ * system calls, no locks -- and the file is there (up to the last
+ * record) even if the program crashes.  Once the ring is full the oldest
+ * records are overwritten.  The clock is the time stamp counter where
+ * there is one (steady_clock elsewhere); open measures how fast it ticks,
+ * and close measures it again over the whole trace.
+ *
+ * tools/trace2json converts a trace to Chrome's JSON trace format (for
+ * chrome://tracing or Perfetto) and prints the hot spots.
+ *
+ * The file format (below) is always defined, so that the tool can read
+ * traces without TRACE_EVENTS.
+ */
+namespace Trace {
+
+const char magic[8] = { 'E', 'P', 'L', 'T', 'R', 'A', 'C', 'E' };
+const uint32_t version = 1;
+
+const uint16_t RESIZE = 0;              // the kind of QuadTree resize callbacks
+const uint16_t NO_SPECIES = 0xffff;
+const unsigned max_kinds = 256;         // handler kinds (more are all "other")
+const unsigned kind_name_size = 120;
+const unsigned max_species = 256;
+const unsigned species_name_size = 32;
+const uint64_t default_capacity = 1 << 20; // records (32 MB)
+
+struct Record {
+    double sim_time;            // when the event happened
+    uint64_t wall;              // when the handler started (ticks since Trace::open)
+    uint64_t object;            // the owner's ID (0 if it had none)
+    uint32_t duration;          // how long the handler took (ticks)
+    uint16_t kind;              // index into Header::kinds
+    uint16_t species;           // SpeciesID of the owner (or NO_SPECIES)
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;       // sizeof(Record)
+    uint64_t capacity;          // Records in the ring
+    uint64_t records_offset;    // where the ring starts in the file
+    double ticks_per_second;    // of Record::wall and Record::duration
+    uint64_t written;           // Records written so far; the ring holds the
+                                // last min(written, capacity) of them, the
+                                // oldest at (written % capacity) once it's full
+    uint32_t num_kinds;
+    uint32_t num_species;
+    char kinds[max_kinds][kind_name_size];          // demangled handler types
+    char species[max_species][species_name_size];
+};
+
+}
+
+#if TRACE_EVENTS
+
+#include <chrono>
+#include <string>
+#include <typeinfo>
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Trace {
+
+#if defined (__x86_64__) || defined (__i386__)
+inline uint64_t ticks(void) { return __rdtsc(); }
+#else
+inline uint64_t ticks(void) { return std::chrono::steady_clock::now().time_since_epoch().count(); }
+#endif
+
+class Recorder;
+
+/* this thread's recorder (null unless Trace::open was called) */
+extern thread_local Recorder* current;
+
+/* start tracing this thread into a (new) file; false if it can't be made */
+bool open(const std::string& file_name, uint64_t capacity = default_capacity);
+void close(void);               // stop tracing this thread (and unmap the file)
+
+uint64_t new_object(void);      // a fresh object ID (never 0)
+
+uint16_t kind(const std::type_info&); // the index for a handler type
+void record(uint16_t kind, double sim_time, uint64_t object, uint32_t species,
+            uint64_t start);
+
+/* record one handler call (for the lifetime of the Span), if tracing */
+class Span {
+    bool on;
+    uint16_t kind;
+    double sim_time;
+    uint64_t object;
+    uint32_t species;
+    uint64_t start;
+
+    Span(const Span&) = delete;
+    void operator=(const Span&) = delete;
+public:
+    Span(const std::type_info& handler, double sim_time, uint64_t object, uint32_t species)
+        : on(current != nullptr), sim_time(sim_time), object(object), species(species) {
+        if (on) {
+            kind = Trace::kind(handler);
+            start = ticks();
+        }
+    }
+    Span(uint16_t kind, double sim_time, uint64_t object, uint32_t species)
+        : on(current != nullptr), kind(kind), sim_time(sim_time), object(object), species(species) {
+        if (on) { start = ticks(); }
+    }
+    ~Span(void) {
+        if (on) { record(kind, sim_time, object, species, start); }
+    }
+};
+
+}
+
+#endif /* TRACE_EVENTS */
+
+#endif /* !(_Trace_h) */
@@ -0,0 +1,54 @@
+#if !(_TripleBuffer_h)
+#define _TripleBuffer_h 1
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * A lock-free triple buffer: one producer hands whole values (e.g., a
+ * snapshot of the world) to one consumer, and neither ever waits.
+ *
+ * The producer fills write_buffer() and then publish()es it.  The
+ * consumer calls acquire(), which switches read_buffer() over to the
+ * newest published value (it returns false if nothing new has been
+ * published since the last acquire).  Values the consumer was too slow
+ * to see are simply overwritten.
+ *
+ * The three buffers are: the producer's (back), the consumer's (front)
+ * and the latest published one (middle).  publish and acquire each swap
+ * their own buffer with the middle one in a single atomic exchange; the
+ * FRESH bit says whether the middle buffer is newer than the front one.
+ *
+ * The buffers themselves are reused, so a T that holds a std::vector
+ * stops allocating once it has grown big enough.
+ */
+template <typename T>
+class TripleBuffer {
+    enum : uint8_t { INDEX = 3, FRESH = 4 };
+
+    T buffers[3];
+    std::atomic<uint8_t> middle;
+    uint8_t back;               // only touched by the producer
+    uint8_t front;              // only touched by the consumer
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    void operator=(const TripleBuffer&) = delete;
+public:
+    TripleBuffer(void) : middle(1), back(0), front(2) {}
+
+    /* producer */
+    T& write_buffer(void) { return buffers[back]; }
+    void publish(void) {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /* consumer */
+    bool acquire(void) {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) { return false; }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T& read_buffer(void) const { return buffers[front]; }
+};
+
+#endif /* !(_TripleBuffer_h) */
@@ -0,0 +1,65 @@
+#if !(_Viewport_h)
+#define _Viewport_h 1
+
+#include <algorithm>
+
+/*
+ * Class name: Viewport
+ * Description:
+ *  The part of the world that a Canvas shows: a centre (in world units)
+ *  and a zoom factor.  zoom == 1 shows the whole world_size x world_size
+ *  world; zoom == 4 shows a quarter of its width around the centre.
+ *  The centre is kept far enough from the edges that the view never
+ *  leaves the world.
+ *
+ *  The world y axis is drawn downwards, the same way scale_y always has.
+ */
+class Viewport {
+    double world;               // the world is [0, world) x [0, world)
+    int width, height;          // in pixels
+    double cx, cy, zoom;
+
+    void clamp(void) {
+        zoom = std::max(zoom, 1.0);
+        double half = world / zoom / 2.0;
+        cx = std::min(std::max(cx, half), world - half);
+        cy = std::min(std::max(cy, half), world - half);
+    }
+public:
+    Viewport(double world_size, int width, int height)
+        : world(world_size), width(width), height(height),
+          cx(world_size / 2.0), cy(world_size / 2.0), zoom(1.0) {}
+
+    void set(double center_x, double center_y, double z) {
+        cx = center_x;
+        cy = center_y;
+        zoom = z;
+        clamp();
+    }
+    void reset(void) { set(world / 2.0, world / 2.0, 1.0); }
+
+    /* interactive controls: pan by a fraction of the view, zoom about the centre */
+    void pan(double fx, double fy) { set(cx + fx * span(), cy + fy * span(), zoom); }
+    void zoom_by(double f) { set(cx, cy, zoom * f); }
+
+    int get_width(void) const { return width; }
+    int get_height(void) const { return height; }
+    double center_x(void) const { return cx; }
+    double center_y(void) const { return cy; }
+    double get_zoom(void) const { return zoom; }
+    bool is_whole_world(void) const { return zoom == 1.0; }
+
+    /* the visible part of the world */
+    double span(void) const { return world / zoom; }
+    double left(void) const { return cx - span() / 2.0; }
+    double right(void) const { return cx + span() / 2.0; }
+    double bottom(void) const { return cy - span() / 2.0; }
+    double top(void) const { return cy + span() / 2.0; }
+
+    /* world -> pixel */
+    int to_x(double x) const { return (int) ((x - left()) * width / span()); }
+    int to_y(double y) const { return (int) ((y - bottom()) * height / span()); }
+    double pixel_size(void) const { return span() / width; } // world units per pixel
+};
+
+#endif /* !(_Viewport_h) */
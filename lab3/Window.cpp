@@ -1,11 +1,13 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if !(NO_WINDOW)
 #include <FL/fl_draw.H>
 #include <FL/Fl_Group.H>
 #include <FL/Fl.H>
 #include <FL/Fl_Box.H>
+#include <FL/Fl_Image.H>
 #include <FL/Fl_Window.H>
 #include <FL/x.H>
 #endif
@@ -20,8 +22,39 @@
 using namespace std;
 #endif /* DEBUG */
 
+#include "FrameBuffer.h"
+#include "Params.h"
 #include "Window.h"
 
+#if !(NO_WINDOW)
+/* a window that lets the user move the Canvas's viewport around */
+class ViewWindow : public Fl_Double_Window {
+    Canvas& canvas;
+public:
+    ViewWindow(Canvas& c, int w, int h, const char* title)
+        : Fl_Double_Window(w, h, title), canvas(c) {}
+
+    int handle(int e) {
+        if (e == FL_KEYDOWN) {
+            Viewport& v = canvas.viewport();
+            switch (Fl::event_key()) {
+            case '+': case '=': v.zoom_by(2.0); break;
+            case '-':           v.zoom_by(0.5); break;
+            case '0':           v.reset(); break;
+            case FL_Left:       v.pan(-0.25, 0.0); break;
+            case FL_Right:      v.pan(0.25, 0.0); break;
+            case FL_Up:         v.pan(0.0, -0.25); break;
+            case FL_Down:       v.pan(0.0, 0.25); break;
+            default:            return Fl_Double_Window::handle(e);
+            }
+            canvas.notify_view_change();
+            return 1;
+        }
+        return Fl_Double_Window::handle(e);
+    }
+};
+#endif /* !(NO_WINDOW) */
+
 /* Allocate colors in an X color map and set them up. */
 void Canvas::initcolor()
 {
@@ -45,9 +78,11 @@ void Canvas::initcolor()
 */
 unsigned int Canvas::initmono(void)
 {
+#if !(NO_WINDOW)
     color_map[BLACK] = FL_BLACK;
     for (int i = 1; i < 8; i++)
       color_map[i] = FL_WHITE;
+#endif /* !(NO_WINDOW) */
     return 0;
 }
 
@@ -56,20 +91,32 @@ unsigned int Canvas::initmono(void)
    mapping, create a window, wait for it to be mapped, draw rectangles
    in various forms, and exit.
 */
-Canvas::Canvas(int w, int h) : width(w), height(h)
+Canvas::Canvas(int w, int h, bool on_screen)
+    : width(w), height(h), color(BLACK), frames(nullptr), view(grid_max, w, h)
 {
 #if !(NO_WINDOW)
 
-    window = new Fl_Double_Window(w, h, "LifeForm Simulation");
+    window = on_screen ? new ViewWindow(*this, w, h, "LifeForm Simulation") : nullptr;
+    image_box = nullptr;
     initcolor();
 
 #endif /* !(NO_WINDOW) */
 }
 
+bool Canvas::is_on_screen(void) const
+{
+#if !(NO_WINDOW)
+    return window != nullptr;
+#else
+    return false;
+#endif
+}
+
 void Canvas::display(void)
 {
 #if !(NO_WINDOW)
 
+    if (!window) { return; }
     window->color(FL_BLACK);
     window->show();
     Fl::wait(0);
@@ -80,11 +127,7 @@ void Canvas::display(void)
 
 void Canvas::set_color(Color x)
 {
-#if !(NO_WINDOW)
-
     color = x;
-
-#endif
 }
 
 int point_size = 3;
@@ -97,6 +140,8 @@ void Canvas::flush(void)
 {
 #if !(NO_WINDOW)
 
+    if (!window) { return; }
+
 #if defined (__APPLE__)
     Fl::flush();
 #else
@@ -109,8 +154,11 @@ void Canvas::flush(void)
 
 void Canvas::draw_rectangle(int x1, int y1, int x2, int y2, bool fill)
 {
+    if (frames) { frames->rectangle(x1, y1, x2, y2, color, fill); }
+
 #if !(NO_WINDOW)
 
+    if (!window) { return; }
     Fl_Box *box;
     if (fill) {
         box = new Fl_Box(x1, y1, (x2 - x1), (y2 - y1));
@@ -128,6 +176,38 @@ void Canvas::draw_rectangle(int x1, int y1, int x2, int y2, bool fill)
 #endif /* !(NO_WINDOW) */
 }
 
+/*
+ * Draw a w x h block of RGBA pixels (top row first) with its upper left
+ * corner at x, y.  The window keeps one image box, which is moved back
+ * on top each time, rather than adding a new widget per frame
+ */
+void Canvas::draw_image(int x, int y, int w, int h, const unsigned char* rgba)
+{
+    if (frames) { frames->image(x, y, w, h, rgba); }
+
+#if !(NO_WINDOW)
+
+    if (!window) { return; }
+    unsigned char* copy = new unsigned char[w * h * 4];
+    memcpy(copy, rgba, w * h * 4);
+    Fl_RGB_Image* img = new Fl_RGB_Image(copy, w, h, 4);
+    img->alloc_array = 1;       // the image deletes 'copy'
+    if (image_box) {
+        delete image_box->image();
+        window->remove(image_box);
+        image_box->resize(x, y, w, h);
+    } else {
+        image_box = new Fl_Box(x, y, w, h);
+        image_box->box(FL_NO_BOX);
+    }
+    image_box->image(img);
+    window->add(image_box);
+    image_box->redraw();
+
+#endif /* !(NO_WINDOW) */
+}
+
+#if !(NO_WINDOW)
 class DrawLine : public Fl_Widget {
 public:
     DrawLine(int X, int Y, int W, int H, const char*L = 0) : Fl_Widget(X, Y, W, H, L) {
@@ -141,10 +221,16 @@ public:
         fl_line(x1, y2, x2, y1);
     }
 };
+#endif /* !(NO_WINDOW) */
+
 void Canvas::draw_line(int x1, int y1, int x2, int y2)
 {
+    if (frames) { frames->draw_line(x1, y1, x2, y2, color); }
+
 #if !(NO_WINDOW)
 
+    if (!window) { return; }
+
     DrawLine drawLine(x1, y1, x2, y2);
     window->add(drawLine);
     drawLine.redraw();
@@ -155,10 +241,17 @@ void Canvas::draw_line(int x1, int y1, int x2, int y2)
 
 void Canvas::clear(void)
 {
+    /* everything recorded so far is covered up anyway */
+    if (frames) { frames->clear(BLACK); }
+
 #if !(NO_WINDOW)
 
+    if (!window) { return; }
+    FrameBuffer* fb = frames;
+    frames = nullptr;           // the background is already recorded
     set_color(BLACK);
     draw_rectangle(0, 0, width, height, true);
+    frames = fb;
 
 #endif /* !(NO_WINDOW) */
 }
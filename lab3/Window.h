@@ -1,11 +1,17 @@
 #if !_Window_h
 #define _Window_h 1
 
+#include <functional>
+
 #include "Color.h"
-
-#if !(NO_WINDOW)
-#include <FL/Fl.H>
+#include "Viewport.h"
+
+class FrameBuffer;
+
+#if !(NO_WINDOW)
+#include <FL/Fl.H>
 #include <FL/Fl_Double_Window.H>
+class Fl_Box;
 #endif
 
 class Canvas {
@@ -16,10 +22,16 @@ private:
     unsigned long color_map[8];
     Color color;
 
-#if ! (NO_WINDOW)
-    Fl_Double_Window *window;  // defined in Fl_Window.H
+#if ! (NO_WINDOW)
+    Fl_Double_Window *window;  // defined in Fl_Window.H (null when off screen)
+    Fl_Box *image_box;         // draw_image reuses this one
 #endif 
 
+    FrameBuffer* frames;       // if set, drawing is also recorded here
+
+    Viewport view;             // the part of the world we show
+    std::function<void(const Viewport&)> view_changed;
+
     int scrn;
     unsigned int plane_mask;
 
@@ -27,14 +39,32 @@ private:
     unsigned initmono(void);
 
 public:
-    Canvas(int width = 600, int height = 450);
+    /* an off-screen Canvas opens no window; it only draws into its
+       FrameBuffer (see record) */
+    Canvas(int width = 600, int height = 450, bool on_screen = true);
     ~Canvas() {} // should close the window, yes?
 
+    int get_width(void) const { return width; }
+    int get_height(void) const { return height; }
+    bool is_on_screen(void) const;
+
+    /* also draw into fb from now on (null to stop) */
+    void record(FrameBuffer* fb) { frames = fb; }
+
+    /* the view can be changed from the keyboard (+ and - zoom, the arrow
+       keys pan, 0 shows the whole world); f is then called, on the thread
+       that runs the window */
+    Viewport& viewport(void) { return view; }
+    const Viewport& viewport(void) const { return view; }
+    void on_view_change(std::function<void(const Viewport&)> f) { view_changed = f; }
+    void notify_view_change(void) { if (view_changed) { view_changed(view); } }
+
     void set_color(Color);
     void display(void);
     void draw_line(int, int, int, int);
     void draw_point(int x, int y);
     void draw_rectangle(int x1, int y1, int, int, bool = true);
+    void draw_image(int x, int y, int w, int h, const unsigned char* rgba);
     void flush(void);
     void clear(void);
 
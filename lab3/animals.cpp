@@ -1,65 +1,224 @@
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <thread>
 #include "LifeForm.h"
-#include "Algae.h"
 #include "Event.h"
+#include "FrameRecorder.h"
+#include "MemoryAccount.h"
 #include "Params.h"
-#include "Random.h"
-
-namespace epl {
-    std::default_random_engine random_generator;
-    std::function<double(void)> drand48 = std::bind(std::uniform_real_distribution<double>{}, random_generator);
-}
+#include "Profile.h"
+#include "Renderer.h"
+#include "Simulation.h"
+#include "StatsStream.h"
+#include "Sweep.h"
+#include "Tournament.h"
+#include "Trace.h"
 
 using namespace std;
-using namespace epl;
 const double Point::tolerance = 1.0e-6;
 
 bool LifeForm::testMode = false;
 void LifeForm::runTests(void) {}
 
-/* The Tick class creates an event every 1.00 time units
-* The event is used to add new Algae to the simulation and can
-* also be used to add debugging hooks if you need them
-*/
-class Tick {
-public:
-    static void tock(void) {
-        std::function<void(void)> callme = [](void) { tock(); };
-#if ALGAE_SPORES    
-        Algae::create_spontaneously();
-#endif /* ALGAE_SPORES */
-        if (Event::num_events() > 1)
-            (void) new Event(1, callme);
-    }
-};
-
+#if SLOWDOWN
+/* 10 ms of wall time per time unit, to watch the simulation crawl.  The
+   Renderer draws on the main thread, so nothing else needs this */
 void delay(void) {
     std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
     new Event(1, &delay);
 }
+#endif /* SLOWDOWN */
+
+/*
+ * usage: animals -t runs [threads [max_time]]
+ * play a tournament: runs independent simulations (with seeds 1..runs)
+ * on a pool of threads (default: one per core) and print the ranking
+ */
+int tournament(int argc, char** argv) {
+    unsigned runs = argc > 2 ? atoi(argv[2]) : 10;
+    unsigned threads = argc > 3 ? atoi(argv[3]) : std::thread::hardware_concurrency();
+    SimTime max_time = argc > 4 ? atof(argv[4]) : MAX_SIMULATION_TIME;
+
+    Tournament t(runs, threads, max_time);
+    t.run();
+    t.report(cout);
+#if PROFILE_EVENTS
+    Profile::report(cout);
+#endif /* PROFILE_EVENTS */
+#if MEMORY_ACCOUNTING
+    memory::report(cout);
+#endif /* MEMORY_ACCOUNTING */
+    return 0;
+}
+
+/*
+ * usage: animals -s sweep_file [fork_time [max_time [jobs]]]
+ * build the world once, run it to fork_time, and then run it on from
+ * there with every parameter set in the sweep_file (see Sweep.h), at
+ * most jobs (default: one per core) at once
+ */
+int sweep(int argc, char** argv) {
+    ifstream in(argv[2]);
+    if (!in) {
+        cerr << "animals: can't read " << argv[2] << "\n";
+        return 1;
+    }
+    SimTime fork_time = argc > 3 ? atof(argv[3]) : 0.0;
+    SimTime max_time = argc > 4 ? atof(argv[4]) : MAX_SIMULATION_TIME;
+    unsigned jobs = argc > 5 ? atoi(argv[5]) : 0;
+
+    Sweep s(fork_time, max_time, jobs);
+    if (!s.read(in)) { return 1; }
+    s.run();
+    s.report(cout);
+    return 0;
+}
 
+/*
+ * usage: animals [-v x y zoom] [-f frame_interval [-p] [-o prefix]]
+ *                [-T trace_file] [-P name=value ...]
+ *                [time_lapse [stats_file [stats_interval]]]
+ * time_lapse is the sim time between redisplays (the window is drawn by
+ * a Renderer on the main thread, from snapshots, while the simulation
+ * runs on a thread of its own).  If a stats_file is
+ * given, a CSV time series is written to it every stats_interval
+ * (default: time_lapse) sim-time units.
+ * -f saves a picture every frame_interval sim-time units as
+ * prefix00000.ppm, ... (-p: PNG instead; the default prefix is "frame").
+ * -v starts the window zoomed in on (x, y); in the window, + and - zoom,
+ * the arrow keys pan and 0 shows the whole world.
+ * -T records every event in trace_file (if compiled with TRACE_EVENTS;
+ * see Trace.h, and tools/trace2json to look at it)
+ * -P sets a parameter (see set_param), e.g. -P decision_window=1; the
+ * -P options can come before -t and -s too
+ */
 int main(int argc, char** argv) {
     double last_time = 0.0;
     double time_lapse;
+    double frame_interval = 0.0;
+    bool png = false;
+    string frame_prefix = "frame";
+    string trace_file;
+    double view_x = grid_max / 2.0, view_y = grid_max / 2.0, view_zoom = 1.0;
+
+    while (argc > 1 && argv[1][0] == '-') {
+        if (strcmp(argv[1], "-t") == 0) {
+            return tournament(argc, argv);
+        } else if (strcmp(argv[1], "-s") == 0 && argc > 2) {
+            return sweep(argc, argv);
+        } else if (strcmp(argv[1], "-f") == 0 && argc > 2) {
+            frame_interval = atof(argv[2]);
+            argc -= 1; argv += 1;
+        } else if (strcmp(argv[1], "-o") == 0 && argc > 2) {
+            frame_prefix = argv[2];
+            argc -= 1; argv += 1;
+        } else if (strcmp(argv[1], "-v") == 0 && argc > 4) {
+            view_x = atof(argv[2]);
+            view_y = atof(argv[3]);
+            view_zoom = atof(argv[4]);
+            argc -= 3; argv += 3;
+        } else if (strcmp(argv[1], "-T") == 0 && argc > 2) {
+            trace_file = argv[2];
+            argc -= 1; argv += 1;
+        } else if (strcmp(argv[1], "-P") == 0 && argc > 2) {
+            string setting = argv[2];
+            size_t eq = setting.find('=');
+            if (eq == string::npos
+                || !set_param(setting.substr(0, eq), setting.substr(eq + 1))) {
+                cerr << "animals: bad parameter " << setting << "\n";
+                return 1;
+            }
+            argc -= 1; argv += 1;
+        } else if (strcmp(argv[1], "-p") == 0) {
+            png = true;
+        } else {
+            cerr << "animals: unknown option " << argv[1] << "\n";
+            return 1;
+        }
+        argc -= 1; argv += 1;
+    }
 
     if (argc > 1)
         time_lapse = atof(argv[1]);
     else
         time_lapse = 1.0;
 
-    LifeForm::create_life();
-    new Event(1, &delay);
-    Tick::tock();
-    while (Event::num_events() > 0) {
-        Event::do_next();
-        // periodically redisplay everything
-        if (Event::now() - last_time > time_lapse) {
-            last_time = Event::now();
-            LifeForm::redisplay_all();
+    /* the simulation, and everything that watches it (the trace, stats,
+       frames and profile are kept per thread) -- publishing to renderer,
+       if there is one */
+    auto simulate = [&](Renderer* renderer) -> int {
+#if TRACE_EVENTS
+        if (!trace_file.empty() && !Trace::open(trace_file))
+            return 1;
+#else
+        if (!trace_file.empty())
+            cerr << "animals: -T needs TRACE_EVENTS=1, not tracing\n";
+#endif /* TRACE_EVENTS */
+
+        Simulation sim(0);      // the Renderer has the window
+        Simulation::Scope scope(sim);
+
+        std::unique_ptr<StatsStream> stats;
+        if (argc > 2)
+            stats.reset(new StatsStream(argv[2], argc > 3 ? atof(argv[3]) : time_lapse));
+
+        std::unique_ptr<FrameRecorder> frames;
+        if (frame_interval > 0.0)
+            frames.reset(new FrameRecorder(frame_prefix, frame_interval, png));
+
+        sim.start();
+        if (renderer) { renderer->publish(); }
+#if SLOWDOWN
+        new Event(1, &delay);
+#endif /* SLOWDOWN */
+        while (sim.step()) {
+            if (stats) { stats->poll(); }
+            if (frames) { frames->poll(); }
+            // periodically redisplay everything
+            if (Event::now() - last_time > time_lapse) {
+                last_time = Event::now();
+                if (renderer) { renderer->publish(); }
+                LifeForm::print_summary();
+            }
         }
-    }
 
+        if (renderer) { renderer->publish(); }  // show the final state
+        if (stats) { stats->sample(); stats->close(); }
+#if PROFILE_EVENTS
+        Profile::report(cout);
+#endif /* PROFILE_EVENTS */
+#if MEMORY_ACCOUNTING
+        vector<SpeciesStats> totals = LifeForm::species_totals();
+        memory::report(cout, &totals);
+#endif /* MEMORY_ACCOUNTING */
+#if TRACE_EVENTS
+        Trace::close();
+#endif /* TRACE_EVENTS */
+        return 0;
+    };
+
+#if NO_WINDOW
+    (void) view_x; (void) view_y; (void) view_zoom;     // no window to view
+    int status = simulate(nullptr);
+#else
+    /* FLTK only works from the main thread, so the simulation moves out */
+    Renderer renderer;
+    Viewport view(grid_max, win_x_size, win_y_size);
+    view.set(view_x, view_y, view_zoom);
+    renderer.set_view(view);
+
+    int status = 0;
+    std::thread simulation([&](void) {
+        status = simulate(&renderer);
+        renderer.close();
+    });
+    renderer.run();
+    simulation.join();
+#endif /* NO_WINDOW */
+    if (status != 0)
+        return status;
     cerr << "Simulation Complete, hit ^C to terminate program\n";
     //  sleep(1000);
 }
@@ -0,0 +1,85 @@
+/*
+ * decisions: check that making decisions on more threads doesn't change
+ * the simulation
+ *
+ * usage: decisions [runs [window [time]]]
+ *
+ * Each of the seeds 1 ... runs is simulated with decision_window set to
+ * window, once with decision_threads=1 and once with decision_threads=4,
+ * until time.  Every species must end up with the same population,
+ * births, deaths, meals and energy (to the last bit) either way, and the
+ * batches must really have been shared.  Needs a PARALLEL_DECISIONS
+ * build (see the Makefile).  create_life reads config.test, so this
+ * writes one in the current directory.
+ */
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "LifeForm.h"
+#include "Params.h"
+#include "Simulation.h"
+#include "Species.h"
+
+#if !PARALLEL_DECISIONS
+#error "checks/decisions needs -DPARALLEL_DECISIONS=1"
+#endif
+
+using namespace std;
+
+/* what animals.cpp defines for the simulator */
+const double Point::tolerance = 1.0e-6;
+bool LifeForm::testMode = false;
+void LifeForm::runTests(void) {}
+
+struct Result {
+    string totals;      // one line per species that ever lived
+    uint64_t shared;    // batches handed to the threads
+};
+
+static Result run(unsigned seed, const string& threads, SimTime time) {
+    set_param("decision_threads", threads);
+    Simulation sim(seed);
+    Simulation::Scope scope(sim);
+    sim.verbose = false;
+    sim.max_time = time;
+    sim.start();
+    sim.run();
+
+    ostringstream out;
+    out.precision(17);
+    const vector<SpeciesStats>& totals = LifeForm::species_totals();
+    for (SpeciesID id = 1; id < totals.size(); ++id) {
+        const SpeciesStats& s = totals[id];
+        if (s.births == 0) { continue; }
+        out << "  " << SpeciesTable::name(id) << ": " << s.alive << " alive, "
+            << s.births << " births, " << s.deaths << " deaths, " << s.eats
+            << " eats, " << s.energy << " energy\n";
+    }
+    return Result{ out.str(), sim.get_decisions().shared() };
+}
+
+int main(int argc, char** argv) {
+    unsigned runs = argc > 1 ? atoi(argv[1]) : 3;
+    string window = argc > 2 ? argv[2] : "5";
+    SimTime time = argc > 3 ? atof(argv[3]) : 300.0;
+    ofstream("config.test") << "Algae 200\nCraig 50\nPraveen 50\n";
+    set_param("decision_window", window);
+
+    bool ok = true;
+    for (unsigned seed = 1; seed <= runs; ++seed) {
+        Result one = run(seed, "1", time);
+        Result four = run(seed, "4", time);
+        bool good = one.totals == four.totals && four.shared > 0;
+        cout << "seed " << seed << ": " << four.shared << " batches shared"
+             << (good ? "" : "  <-- FAILED") << "\n" << four.totals;
+        if (one.totals != four.totals) {
+            cout << " with 1 thread:\n" << one.totals;
+        }
+        ok = ok && good;
+    }
+    cout << (ok ? "ok\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
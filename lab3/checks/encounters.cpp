@@ -0,0 +1,139 @@
+/*
+ * encounters: check that the BroadPhase finds the same encounters in
+ * either mode, and while switching between them
+ *
+ * usage: encounters [walkers [rocks [runs]]]
+ *
+ * Every Walker looks for the closest Rock, heads straight for it, and
+ * stops at the first stationary object it meets (a Rock, an algae spore
+ * or a Walker that stopped already).  Encounters cost nothing here, so
+ * nobody dies of them, and each Walker that saw a Rock stops exactly
+ * once, however the encounters are found.  The same world is run with
+ * the border_cross events only, with the stepped sweep only, and
+ * switching modes at every check; the counts must agree (and the last
+ * two runs must really have stepped, and switched).  That is done for
+ * each of the seeds 1 ... runs.  create_life reads config.test, so this
+ * writes one in the current directory.
+ */
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "BroadPhase.h"
+#include "Event.h"
+#include "Init.h"
+#include "LifeForm.h"
+#include "ObjInfo.h"
+#include "Params.h"
+#include "Simulation.h"
+
+using namespace std;
+
+/* what animals.cpp defines for the simulator */
+const double Point::tolerance = 1.0e-6;
+bool LifeForm::testMode = false;
+void LifeForm::runTests(void) {}
+
+static unsigned aimed = 0;      // Walkers that saw a Rock
+static unsigned met = 0;        // Walkers that met something and stopped
+
+class Rock : public LifeForm {
+    static void initialize(void) { add_creator(create, "Rock"); }
+public:
+    Color my_color(void) const { return YELLOW; }
+    string species_name(void) const { return "Rock"; }
+    Action encounter(const ObjInfo&) { return LIFEFORM_IGNORE; }
+    static SmartPointer<LifeForm> create(void) { return make_smart<Rock>(); }
+    friend class Initializer<Rock>;
+};
+
+class Walker : public LifeForm {
+    static void initialize(void) { add_creator(create, "Walker"); }
+    void startup(void) {
+        static const SpeciesID rock = SpeciesTable::intern("Rock");
+        double best = HUGE, course = 0.0;
+        for (const ObjInfo& i : perceive(params::Active::max_perceive_range())) {
+            if (i.species.id() == rock && i.distance < best) {
+                best = i.distance;
+                course = i.bearing;
+            }
+        }
+        if (best == HUGE) { return; }
+        aimed += 1;
+        set_course(course);
+        set_speed(5.0);
+    }
+public:
+    Walker(void) {
+        WeakPointer<Walker> self{ this };
+        new Event(0, [self](void) { if (auto p = self.lock()) { p->startup(); } }, this);
+    }
+    Color my_color(void) const { return CYAN; }
+    string species_name(void) const { return "Walker"; }
+    Action encounter(const ObjInfo& info) {
+        if (info.their_speed == 0.0 && get_speed() > 0.0) {
+            met += 1;
+            set_speed(0.0);
+        }
+        return LIFEFORM_IGNORE;
+    }
+    static SmartPointer<LifeForm> create(void) { return make_smart<Walker>(); }
+    friend class Initializer<Walker>;
+};
+
+Initializer<Rock> __Rock_initializer;
+Initializer<Walker> __Walker_initializer;
+
+struct Result {
+    unsigned aimed, met;
+    uint64_t steps, switches;
+};
+
+static Result run(unsigned seed, const string& enter, const string& leave) {
+    set_param("step_mode_enter", enter);
+    set_param("step_mode_leave", leave);
+    aimed = met = 0;
+    Simulation sim(seed);
+    Simulation::Scope scope(sim);
+    sim.verbose = false;
+    sim.max_time = 60.0;
+    sim.start();
+    sim.run();
+    return Result{ aimed, met, sim.get_broad_phase().steps, sim.get_broad_phase().switches };
+}
+
+int main(int argc, char** argv) {
+    unsigned walkers = argc > 1 ? atoi(argv[1]) : 400;
+    unsigned rocks = argc > 2 ? atoi(argv[2]) : 300;
+    unsigned runs = argc > 3 ? atoi(argv[3]) : 5;
+    ofstream("config.test") << "Rock " << rocks << "\nWalker " << walkers << "\n";
+    if (!set_param("encounter_penalty", "0")) {
+        cerr << "encounters: can't set encounter_penalty (build with CONSTANT_PARAMS=0)\n";
+        return 1;
+    }
+
+    bool ok = true;
+    for (unsigned seed = 1; seed <= runs; ++seed) {
+        Result events = run(seed, "1e30", "0");     // never steps
+        Result stepped = run(seed, "0", "0");       // steps from the first check on
+        Result switching = run(seed, "0", "1e30");  // switches at every check
+
+        /* (once every Walker has stopped, a stepping BroadPhase goes back
+           to events -- that is one switch in, one out) */
+        auto show = [&ok, &events, seed](const char* name, const Result& r, bool steps, bool switches) {
+            bool good = r.aimed == events.aimed && r.met == r.aimed
+                     && (r.steps > 0) == steps && (r.switches > 2) == switches;
+            cout << "seed " << seed << " " << name << ": " << r.met << " of " << r.aimed
+                 << " walkers stopped, " << r.steps << " steps, " << r.switches << " switches"
+                 << (good ? "" : "  <-- FAILED") << "\n";
+            ok = ok && good;
+        };
+        show("events   ", events, false, false);
+        show("stepped  ", stepped, true, false);
+        show("switching", switching, true, true);
+    }
+    cout << (ok ? "ok\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#if !(_Bridge_h)
+#define _Bridge_h 1
+
+#include <cstddef>
+
+/*
+ * The calls between the species handed in as object files and the
+ * simulator.  Those species were compiled against the headers in this
+ * directory (with the old std::string), so they are run by
+ * legacy/OldLifeForm.cpp, which is compiled against the same headers,
+ * and each of them is represented in the simulation by a Legacy (see
+ * Legacy.h).  The two sides can't share a header for anything else, so
+ * only plain types cross here.
+ */
+namespace legacy {
+
+struct Species;                 // an old LifeForm (legacy/LifeForm.h)
+struct Proxy;                   // the Legacy standing in for it
+struct Task;                    // an old Event
+
+/* an ObjInfo (the species name is the simulator's, and never goes away) */
+struct Info {
+    const char* species;
+    double health;
+    double distance;
+    double bearing;
+    double their_speed;
+    double their_course;
+};
+
+/* what the old LifeForm's inline accessors read */
+struct State {
+    double energy;
+    bool alive;
+    double course;
+    double speed;
+};
+
+/*
+ * The old side, handed to the simulator with each creator.  Each call
+ * takes the lock that keeps the old objects to one thread at a time
+ * (they have one clock and plain reference counts between them)
+ */
+struct Ops {
+    Species* (*create)(unsigned creator);       // holds a reference
+    void (*attach)(Species*, Proxy*);
+    void (*release)(Species*);                  // the Proxy is gone
+    int (*encounter)(Species*, const Info&);    // an Action
+    int (*color)(Species*);                     // a Color
+    const char* (*species_name)(Species*);      // good until the next call
+    const char* (*player_name)(Species*);
+    void (*draw)(Species*, int x, int y);
+    void (*run)(Task*, Species* holder);        // the Task's time has come
+    void (*drop)(Task*, Species* holder);       // delete it (run or not)
+};
+
+/* the simulator side, for the old LifeForm's member functions */
+struct Sim {
+    static void add_creator(const char* name, unsigned creator, const Ops*);
+    static double now(void);
+    static void state(Proxy*, State&);
+    static bool is_alive(Proxy*);
+    static void set_course(Proxy*, double);
+    static void set_speed(Proxy*, double);
+    static void perceive(Proxy*, double range, void (*add)(void* list, const Info&), void* list);
+    static void reproduce(Proxy*, Species* child, const Ops*); // takes a reference
+    static void draw(Proxy*, int x, int y);     // the simulator's LifeForm::draw
+    static void display(Proxy*);
+    /* its code has run, so its species_name() may be different now */
+    static void renamed(Proxy*);
+    /* run (or drop) the task at time t, holding a reference to its
+       holder; the owner (if any) cancels it when it dies */
+    static void schedule(Task*, double t, Species* holder, Proxy* owner, const Ops*);
+};
+
+}
+
+#endif /* !(_Bridge_h) */
@@ -0,0 +1,308 @@
+/*
+ * OldLifeForm.cpp: the LifeForm and Event that the species handed in as
+ * object files were compiled against, built on top of the simulator's
+ *
+ * The headers in this directory are the ones those species were built
+ * with, unchanged.  rename.sh renames their classes in the objects
+ * (LifeForm -> OldLifeForm, ...), and the #defines below compile these
+ * headers under the same names, so the two sides meet here and nowhere
+ * else.  Each old object is put into the simulation as a Legacy (see
+ * Legacy.h), which passes the simulator's calls on to it; its own calls
+ * to set_course, perceive, reproduce, ... are passed back to the Legacy
+ * through legacy::Sim (see Bridge.h).
+ *
+ * The old Event is only a holder for the handler now: insert() hands it
+ * to the simulator's queue, which runs it at its time (if the object it
+ * was made for is still alive) and then has it deleted here.
+ */
+#define _GLIBCXX_USE_CXX11_ABI 0    // the objects were built with the old std::string
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define LifeForm OldLifeForm
+#define Event OldEvent
+#define ObjInfo OldObjInfo
+#define SmartPointer OldSmartPointer
+#define ControlBlock OldControlBlock
+/* Runner stands in for the only friends the old LifeForm and Event have */
+#define Algae Runner
+#define EventCompare Runner
+
+#include "LifeForm.h"
+#include "Event.h"
+#include "ObjInfo.h"
+#include "Bridge.h"
+
+using namespace std;
+using legacy::Info;
+using legacy::Ops;
+using legacy::Proxy;
+using legacy::Sim;
+using legacy::Species;
+using legacy::State;
+using legacy::Task;
+
+/*
+ * Class name: Runner
+ * Description:
+ *  Runs the old objects for the simulator: every call into their code
+ *  is made through an Enter, which holds the lock, sets the old clock and
+ *  brings the object's fields (the ones the old inline accessors read)
+ *  up to date.  The old objects share one clock and their reference
+ *  counts are not atomic, so only one thread runs their code at a time.
+ */
+class Runner {
+    static recursive_mutex& lock(void) {
+        static recursive_mutex the_lock;
+        return the_lock;
+    }
+
+    /* the Legacy of each old object that is in the simulation */
+    static unordered_map<const LifeForm*, Proxy*>& proxies(void) {
+        static unordered_map<const LifeForm*, Proxy*> the_proxies;
+        return the_proxies;
+    }
+
+    /* the creators the old objects registered, by index */
+    static vector<IstreamCreator>& creators(void) {
+        static vector<IstreamCreator> the_creators;
+        return the_creators;
+    }
+
+    static thread_local LifeForm* entered;   // whose code is running
+    static thread_local LifeForm* newest;    // made by that code, and not yet in the simulation
+    static thread_local unsigned depth;
+
+    /* k is kept until its code returns, even if it dies meanwhile.  Code
+       that acts (an encounter or an event) may change what species_name()
+       returns, so the simulator is told to look it up again */
+    class Enter {
+        lock_guard<recursive_mutex> guard;
+        LifeForm* k;
+        LifeForm* prev;
+        bool acts;
+    public:
+        explicit Enter(LifeForm* k, bool acts = false)
+            : guard(lock()), k(k), prev(entered), acts(acts) {
+            entered = k;
+            depth += 1;
+            Event::_now = Sim::now();
+            if (k) {
+                retain(k);
+                k->update_position();
+            }
+        }
+        ~Enter(void) {
+            entered = prev;
+            if (--depth == 0) { newest = nullptr; }
+            if (!k) { return; }
+            if (Proxy* p = acts ? proxy(k) : nullptr) { Sim::renamed(p); }
+            release(k);
+        }
+    };
+
+    static LifeForm* old(Species* s) { return reinterpret_cast<LifeForm*>(s); }
+    static Species* species(LifeForm* k) { return reinterpret_cast<Species*>(k); }
+    static Event* old(Task* t) { return reinterpret_cast<Event*>(t); }
+    static Task* task(Event* e) { return reinterpret_cast<Task*>(e); }
+
+    static Proxy* proxy(const LifeForm* k) {
+        auto p = proxies().find(k);
+        return p == proxies().end() ? nullptr : p->second;
+    }
+    static void retain(LifeForm* k) { k->ref_count += 1; }
+    static void release(LifeForm* k) {
+        if (--k->ref_count == 0) { delete k; }
+    }
+
+    static void add(void* list, const Info& i) {
+        ObjInfo o;
+        o.species = i.species;
+        o.health = i.health;
+        o.distance = i.distance;
+        o.bearing = i.bearing;
+        o.their_speed = i.their_speed;
+        o.their_course = i.their_course;
+        static_cast<ObjList*>(list)->push_back(o);
+    }
+
+    /* Ops */
+    static Species* create(unsigned creator) {
+        Enter e(nullptr);
+        SmartPointer<LifeForm> k = creators()[creator]();
+        retain(&*k);
+        return species(&*k);
+    }
+    static void attach(Species* s, Proxy* p) {
+        lock_guard<recursive_mutex> guard(lock());
+        proxies()[old(s)] = p;
+        if (newest == old(s)) { newest = nullptr; }
+        old(s)->update_position();
+    }
+    static void detach(Species* s) {
+        lock_guard<recursive_mutex> guard(lock());
+        proxies().erase(old(s));
+        old(s)->update_position();
+        release(old(s));
+    }
+    static int encounter(Species* s, const Info& i) {
+        Enter e(old(s), true);
+        ObjList info;
+        add(&info, i);
+        return old(s)->encounter(info[0]);
+    }
+    static int color(Species* s) {
+        Enter e(old(s));
+        return old(s)->my_color();
+    }
+    static const char* species_name(Species* s) {
+        Enter e(old(s));
+        static thread_local string name;
+        name = old(s)->species_name();
+        return name.c_str();
+    }
+    static const char* player_name(Species* s) {
+        Enter e(old(s));
+        static thread_local string name;
+        name = old(s)->player_name();
+        return name.c_str();
+    }
+    static void draw(Species* s, int x, int y) {
+        Enter e(old(s));
+        old(s)->draw(x, y);
+    }
+    static void run(Task* t, Species* holder) {
+        Enter e(old(holder), true);
+        Proxy* p = holder ? proxy(old(holder)) : nullptr;
+        if (p && Sim::is_alive(p)) { (*old(t))(); }
+    }
+    static void drop(Task* t, Species* holder) {
+        lock_guard<recursive_mutex> guard(lock());
+        delete old(t);
+        if (holder) { release(old(holder)); }
+    }
+
+    static const Ops ops;
+
+    friend class LifeForm;
+    friend class Event;
+};
+
+thread_local LifeForm* Runner::entered = nullptr;
+thread_local LifeForm* Runner::newest = nullptr;
+thread_local unsigned Runner::depth = 0;
+
+const Ops Runner::ops = {
+    create, attach, detach, encounter, color, species_name, player_name, draw, run, drop
+};
+
+/*
+ * the old LifeForm.  Until it is in the simulation (and after it has
+ * left), it is a LifeForm that is not alive, and nothing it asks for
+ * happens
+ */
+LifeForm::LifeForm(void) {
+    energy = start_energy;
+    course = speed = 0.0;
+    pos = Point(0, 0);
+    is_alive = false;
+    update_time = 0.0;
+    reproduce_time = 0.0;
+    border_cross_event = nullptr;
+    vector_pos = 0;
+    Runner::newest = this;
+}
+
+LifeForm::~LifeForm(void) {
+    if (Runner::newest == this) { Runner::newest = nullptr; }
+}
+
+/* updates all of the fields the inline accessors read, not just the position */
+void LifeForm::update_position(void) {
+    Proxy* p = Runner::proxy(this);
+    if (!p) {
+        is_alive = false;
+        return;
+    }
+    State s;
+    Sim::state(p, s);
+    energy = s.energy;
+    is_alive = s.alive;
+    course = s.course;
+    speed = s.speed;
+}
+
+void LifeForm::add_creator(IstreamCreator f, const string& name) {
+    Runner::creators().push_back(f);
+    Sim::add_creator(name.c_str(), Runner::creators().size() - 1, &Runner::ops);
+}
+
+void LifeForm::set_course(double c) {
+    if (Proxy* p = Runner::proxy(this)) {
+        Sim::set_course(p, c);
+        update_position();
+    }
+}
+
+void LifeForm::set_speed(double s) {
+    if (Proxy* p = Runner::proxy(this)) {
+        Sim::set_speed(p, s);
+        update_position();
+    }
+}
+
+ObjList LifeForm::perceive(double range) {
+    ObjList list;
+    if (Proxy* p = Runner::proxy(this)) {
+        Sim::perceive(p, range, Runner::add, &list);
+        update_position();
+    }
+    return list;
+}
+
+void LifeForm::reproduce(SmartPointer<LifeForm> child) {
+    Proxy* p = Runner::proxy(this);
+    if (!p || !child || Runner::proxy(&*child)) { return; }
+    Runner::retain(&*child);
+    Sim::reproduce(p, Runner::species(&*child), &Runner::ops);
+    update_position();
+    child->update_position();
+}
+
+void LifeForm::draw(int x, int y) const {
+    if (Proxy* p = Runner::proxy(this)) { Sim::draw(p, x, y); }
+}
+
+void LifeForm::display(void) const {
+    if (Proxy* p = Runner::proxy(this)) { Sim::display(p); }
+}
+
+string LifeForm::player_name(void) const {
+    return species_name();
+}
+
+/* the old clock, set by each Enter (the objects read it inline) */
+SimTime Event::_now = 0;
+
+/*
+ * an Event made by code running for one old object belongs to it -- or
+ * to the object that code has just made, if there is one (e.g., the
+ * first event a constructor schedules, before reproduce) -- and only
+ * happens if that object is alive by then
+ */
+void Event::insert(void) {
+    LifeForm* holder = Runner::newest ? Runner::newest : Runner::entered;
+    Proxy* owner = nullptr;
+    if (holder) {
+        Runner::retain(holder);
+        owner = Runner::proxy(holder);
+    }
+    in_queue = false;
+    Sim::schedule(Runner::task(this), t, Runner::species(holder), owner, &Runner::ops);
+}
+
+Event::~Event(void) {}
@@ -0,0 +1,33 @@
+#!/bin/sh
+#
+# rename.sh: make a species handed in as an object file linkable
+#
+# usage: rename.sh species.o renamed.o
+#
+# The species were compiled against the headers in this directory, whose
+# LifeForm, Event, ObjInfo and SmartPointer have the same names as the
+# simulator's but nothing else in common.  This gives every symbol that
+# mentions one of them the name legacy/OldLifeForm.cpp compiles them under
+# (LifeForm -> OldLifeForm, ...), so the species get the old classes and
+# the simulator keeps its own.  drand48, lrand48 and mrand48 are sent to
+# Legacy.cpp, which draws them from the current Simulation's generator
+# instead of the C library's single, global one.
+#
+set -e
+in=$1
+out=$2
+syms=$out.syms
+
+nm -P "$in" | awk '{ print $1 }' | sort -u | sed -n \
+    -e 'h' \
+    -e 's/\([^0-9]\)8LifeForm/\111OldLifeForm/g' \
+    -e 's/\([^0-9]\)5Event/\18OldEvent/g' \
+    -e 's/\([^0-9]\)7ObjInfo/\110OldObjInfo/g' \
+    -e 's/\([^0-9]\)12SmartPointer/\115OldSmartPointer/g' \
+    -e 's/\([^0-9]\)12ControlBlock/\115OldControlBlock/g' \
+    -e 's/^\([dlm]rand48\)$/legacy_\1/' \
+    -e 'x' -e 'G' -e 's/\n/ /' \
+    -e '/^\([^ ]*\) \1$/d' -e 'p' > "$syms"
+
+objcopy --redefine-syms="$syms" "$in" "$out"
+rm -f "$syms"
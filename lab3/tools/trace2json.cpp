@@ -0,0 +1,188 @@
+/*
+ * trace2json: look at an event trace written by "animals -T file"
+ * (see Trace.h)
+ *
+ * usage: trace2json trace_file [json_file [rows]]
+ *
+ * Prints the hot spots -- the handler kinds, (species, handler) pairs and
+ * objects that took the most time, and the sim-time instants with the
+ * most events -- and, if a json_file is given, writes the trace in
+ * Chrome's JSON trace format (load it in chrome://tracing or
+ * https://ui.perfetto.dev).  Each handler call is a complete ("X")
+ * event; QuadTree resize callbacks are nested inside the event that
+ * caused them.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Trace.h"
+
+using namespace std;
+using namespace Trace;
+
+struct Total {
+    uint64_t calls = 0;
+    uint64_t ns = 0;
+    uint64_t max_ns = 0;
+
+    void add(uint64_t d) {
+        calls += 1;
+        ns += d;
+        max_ns = max(max_ns, d);
+    }
+};
+
+static string json_string(const string& s) {
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if ((unsigned char) c < 0x20) { out += ' '; }
+        else { out += c; }
+    }
+    return out + "\"";
+}
+
+template <typename Key>
+static vector<pair<Key, Total>> ranked(const map<Key, Total>& m, unsigned rows) {
+    vector<pair<Key, Total>> v(m.begin(), m.end());
+    sort(v.begin(), v.end(), [](const pair<Key, Total>& a, const pair<Key, Total>& b) {
+        return a.second.ns > b.second.ns;
+    });
+    if (v.size() > rows) { v.resize(rows); }
+    return v;
+}
+
+static void print_row(const string& name, const Total& t, uint64_t all_ns) {
+    cout << "  " << setw(10) << t.calls
+         << setw(12) << setprecision(3) << fixed << t.ns / 1e6
+         << setw(7) << setprecision(1) << (all_ns ? 100.0 * t.ns / all_ns : 0.0)
+         << setw(10) << setprecision(2) << (t.calls ? t.ns / 1e3 / t.calls : 0.0)
+         << setw(10) << setprecision(2) << t.max_ns / 1e3
+         << "  " << name << "\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "usage: trace2json trace_file [json_file [rows]]\n";
+        return 1;
+    }
+    unsigned rows = argc > 3 ? atoi(argv[3]) : 15;
+
+    ifstream in(argv[1], ios::binary);
+    Header* header = new Header;
+    if (!in.read((char*) header, sizeof(Header))
+        || memcmp(header->magic, magic, sizeof(magic)) != 0) {
+        cerr << "trace2json: " << argv[1] << " is not a trace\n";
+        return 1;
+    }
+    if (header->version != version || header->record_size != sizeof(Record)) {
+        cerr << "trace2json: " << argv[1] << " is trace version " << header->version
+             << ", this is version " << version << "\n";
+        return 1;
+    }
+
+    /* the ring, oldest record first */
+    uint64_t n = min(header->written, header->capacity);
+    vector<Record> ring(n);
+    in.seekg(header->records_offset);
+    in.read((char*) ring.data(), n * sizeof(Record));
+    n = in.gcount() / sizeof(Record);   // a trace cut short by a crash
+    ring.resize(n);
+    if (header->written > header->capacity) {
+        rotate(ring.begin(), ring.begin() + header->written % header->capacity, ring.end());
+    }
+
+    /* Records count clock ticks */
+    double ns_per_tick = header->ticks_per_second > 0.0 ? 1e9 / header->ticks_per_second : 1.0;
+    auto ns = [ns_per_tick](uint64_t t) -> uint64_t { return (uint64_t) (t * ns_per_tick); };
+
+    auto kind_name = [header](uint16_t k) -> string {
+        return k < header->num_kinds ? header->kinds[k] : "?";
+    };
+    auto species_name = [header](uint16_t s) -> string {
+        if (s == NO_SPECIES) { return "(none)"; }
+        return s < header->num_species ? header->species[s] : "?";
+    };
+
+    map<uint16_t, Total> by_kind;
+    map<pair<uint16_t, uint16_t>, Total> by_species;
+    map<uint64_t, Total> by_object;
+    map<double, uint64_t> by_time;
+    uint64_t all_ns = 0;
+    for (const Record& r : ring) {
+        uint64_t d = ns(r.duration);
+        by_kind[r.kind].add(d);
+        by_species[make_pair(r.species, r.kind)].add(d);
+        if (r.object) { by_object[r.object].add(d); }
+        by_time[r.sim_time] += 1;
+        if (r.kind != RESIZE) { all_ns += d; } // resizes are inside events
+    }
+
+    cout << argv[1] << ": " << n << " records";
+    if (header->written > n) { cout << " (the last of " << header->written << ")"; }
+    if (n) {
+        cout << ", sim time " << ring.front().sim_time << " to " << ring.back().sim_time
+             << ", " << setprecision(3) << fixed
+             << ns(ring.back().wall - ring.front().wall) / 1e9 << " s";
+    }
+    cout << "\n\n       calls          ms      %   mean us    max us\n";
+
+    cout << "by handler:\n";
+    for (auto& k : ranked(by_kind, rows)) { print_row(kind_name(k.first), k.second, all_ns); }
+
+    cout << "by species and handler:\n";
+    for (auto& k : ranked(by_species, rows)) {
+        print_row(species_name(k.first.first) + "  " + kind_name(k.first.second), k.second, all_ns);
+    }
+
+    cout << "by object:\n";
+    for (auto& k : ranked(by_object, rows)) {
+        print_row("object " + to_string(k.first), k.second, all_ns);
+    }
+
+    /* many events at the same instant are usually a scheduling problem */
+    vector<pair<double, uint64_t>> instants(by_time.begin(), by_time.end());
+    sort(instants.begin(), instants.end(),
+         [](const pair<double, uint64_t>& a, const pair<double, uint64_t>& b) {
+             return a.second > b.second;
+         });
+    cout << "busiest sim times:\n";
+    for (unsigned k = 0; k < instants.size() && k < 5; ++k) {
+        cout << "  " << setw(10) << instants[k].second << " events at "
+             << setprecision(6) << instants[k].first << "\n";
+    }
+
+    if (argc > 2) {
+        ofstream out(argv[2]);
+        if (!out) {
+            cerr << "trace2json: can't write " << argv[2] << "\n";
+            return 1;
+        }
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        out << setprecision(3) << fixed;
+        bool first = true;
+        for (const Record& r : ring) {
+            out << (first ? "" : ",\n")
+                << "{\"name\":" << json_string(kind_name(r.kind))
+                << ",\"cat\":" << json_string(species_name(r.species))
+                << ",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+                << ",\"ts\":" << ns(r.wall) / 1e3
+                << ",\"dur\":" << ns(r.duration) / 1e3
+                << ",\"args\":{\"sim_time\":" << setprecision(9) << r.sim_time << setprecision(3)
+                << ",\"object\":" << r.object << "}}";
+            first = false;
+        }
+        out << "\n]}\n";
+        cout << "wrote " << argv[2] << "\n";
+    }
+    delete header;
+    return 0;
+}